@@ -11,19 +11,53 @@
 // the AVL tree acts like a binary search tree (e.g., it will become
 // degenerate if elements are added in ascending order).
 //
-// You are not permitted to use the containers in the C++ Standard Library
-// (such as std::set, std::map, or std::vector) to store the information
-// in your data structure.  Instead, you'll need to implement your AVL tree
-// using your own dynamically-allocated nodes, with pointers connecting them,
-// and with your own balancing algorithms used.
+// The nodes live in one contiguous array (a std::vector), in the order
+// they were added, and refer to one another by their 32-bit indices in it
+// rather than by pointers.  That makes each node considerably smaller than
+// one linked by 64-bit pointers, keeps the nodes near the root (which were
+// mostly added early) close together, where they tend to stay in the
+// cache, and lets the whole tree be copied or destroyed at once.  The
+// balancing algorithms are our own; the array is only storage.  Since
+// an index must fit in the 30 bits a node has for its parent's, an AVLSet
+// can hold at most 2^30 - 1 elements -- over a billion, far beyond the
+// 400,000 words of a large dictionary -- and adding more throws a
+// std::length_error.
+//
+// Each node also keeps its parent's index and its "balance factor" (the
+// height of its right subtree minus the height of its left), packed into
+// one 32-bit word, which is all that's needed to rebalance the tree after
+// an addition.  Additions are done iteratively -- descending to the new
+// node's position, then walking back up through the parents, rotating
+// where necessary -- so that even a degenerate, unbalanced tree can't
+// exhaust the stack.
+//
+// Balanced AVLSets can also be split at a key, joined end to end, and
+// merged with one another, using the "join" algorithm (which links two
+// trees of different heights under a middle node by descending the
+// taller one's spine and retracing, as an addition does).  These let a
+// large set be built on several threads at once, a piece per thread, and
+// let a small set be merged into a large one without adding its elements
+// one at a time.  Nodes that a split takes away from a set are kept on a
+// free list in its array, to be reused by later additions.
 
 #ifndef AVLSET_HPP
 #define AVLSET_HPP
 
-#include <functional>
-#include "Set.hpp"
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
+#include "FrozenOrderedSet.hpp"
+#include "KeyLookup.hpp"
+#include "Set.hpp"
 
 template <typename ElementType>
 class AVLSet : public Set<ElementType>
@@ -33,10 +67,24 @@ public:
     // ElementType and returns no value.
     using VisitFunction = std::function<void(const ElementType&)>;
 
+    // An Iterator visits the elements of an AVLSet in ascending order (see
+    // begin() and end() below).  The elements can't be modified through it,
+    // so iterator and const_iterator are the same type.
+    class Iterator;
+    using iterator = Iterator;
+    using const_iterator = Iterator;
+
 public:
     // Initializes an AVLSet to be empty, with or without balancing.
     explicit AVLSet(bool shouldBalance = true);
 
+    // Initializes an AVLSet to contain the elements in the range [first,
+    // last), as though they were passed to bulkLoad().
+    template <
+        typename InputIterator,
+        typename = typename std::iterator_traits<InputIterator>::iterator_category>
+    AVLSet(InputIterator first, InputIterator last, bool shouldBalance = true);
+
     // Cleans up the AVLSet so that it leaks no memory.
     ~AVLSet() noexcept override;
 
@@ -65,12 +113,100 @@ public:
     void add(const ElementType& element) override;
 
 
+    // bulkLoad() adds the elements in the range [first, last) to the set.
+    // When the set is empty and the elements are in ascending order (as
+    // they are in a sorted word list), the tree is built directly, in
+    // linear time, as a perfectly balanced tree, without any searching or
+    // rotations; duplicates are skipped.  The order is checked as the
+    // elements are taken, so if an element turns out to be out of order,
+    // the elements before it are built into a tree that way, and it and
+    // the rest are added one at a time.
+    template <typename InputIterator>
+    void bulkLoad(InputIterator first, InputIterator last);
+
+
     // contains() returns true if the given element is already in the set,
     // false otherwise.  This function always runs in O(log n) time when
     // there are n elements in the AVL tree.
     bool contains(const ElementType& element) const override;
 
 
+    // contains() can also be given a key of another type that can be
+    // compared to the elements directly -- for an AVLSet<std::string>, a
+    // std::string_view or a string literal -- so that the caller needn't
+    // build an ElementType just to search for it.  (See KeyLookup.hpp.)
+    template <typename KeyType, typename = impl_::Set__TransparentKey<ElementType, KeyType>>
+    bool contains(const KeyType& key) const;
+
+
+    // lowerBound() returns a pointer to the smallest element that is not
+    // less than the given key, or nullptr if there is no such element.
+    // upperBound() returns a pointer to the smallest element that is
+    // greater than the given key, or nullptr if there is no such element.
+    // Both run in O(log n) time, and can be given a key of any type that
+    // contains() can.  The pointers remain valid until the AVLSet changes.
+    const ElementType* lowerBound(const ElementType& key) const;
+    const ElementType* upperBound(const ElementType& key) const;
+
+    template <typename KeyType, typename = impl_::Set__TransparentKey<ElementType, KeyType>>
+    const ElementType* lowerBound(const KeyType& key) const;
+
+    template <typename KeyType, typename = impl_::Set__TransparentKey<ElementType, KeyType>>
+    const ElementType* upperBound(const KeyType& key) const;
+
+
+    // visitRange() calls the given "visit" function for each of the elements
+    // that are not less than "low" but are less than "high," in ascending
+    // order.  This function runs in O(log n + k) time when there are n
+    // elements in the AVL tree and k of them are visited.
+    void visitRange(const ElementType& low, const ElementType& high, VisitFunction visit) const;
+
+
+    // visitPrefix() calls the given "visit" function for each of the
+    // elements that begin with the given prefix, in ascending order, for an
+    // AVLSet<std::string>.  Like visitRange(), it runs in O(log n + k) time.
+    template <
+        typename E = ElementType,
+        typename = std::enable_if_t<std::is_same_v<E, std::string>>>
+    void visitPrefix(std::string_view prefix, VisitFunction visit) const;
+
+
+    // split() removes the elements that are not less than the given key
+    // from the set and returns them as a new AVLSet, leaving the set with
+    // only the elements less than the key.  For a balanced set, this runs
+    // in O(log n + k) time when there are n elements and k of them are
+    // removed (the k nodes being moved into the new set's array).
+    AVLSet split(const ElementType& key);
+
+
+    // join() adds all of the elements of the given AVLSet, each of which
+    // should be greater than every element of this one, to this set.  For
+    // balanced sets, linking the trees takes only O(log n) time, after the
+    // smaller set's nodes are moved into the larger one's array.  If the
+    // elements overlap after all, this does what unionWith() does.
+    void join(AVLSet greater);
+
+
+    // unionWith() adds all of the elements of the given AVLSet to this set.
+    // For balanced sets, this runs in O(m log(n/m + 1)) time, where m and n
+    // are the sizes of the smaller and larger sets, by splitting the larger
+    // tree around the smaller one's elements and joining the pieces.  An
+    // unbalanced set's elements are simply added one at a time.
+    void unionWith(AVLSet other);
+
+
+    // buildInParallel() returns a balanced AVLSet containing the elements
+    // in the range [first, last), building it on the given number of
+    // threads: each builds a set from its own piece of the range (see
+    // bulkLoad()), then the pieces are joined together in pairs, in
+    // parallel, until one is left.  When the range is sorted, as a word
+    // list is, every join is a cheap one.
+    template <typename RandomAccessIterator>
+    static AVLSet buildInParallel(
+        RandomAccessIterator first, RandomAccessIterator last,
+        unsigned int threadCount = std::thread::hardware_concurrency());
+
+
     // size() returns the number of elements in the set.
     unsigned int size() const noexcept override;
 
@@ -80,9 +216,26 @@ public:
     int height() const noexcept;
 
 
+    // begin() returns an Iterator positioned at the smallest element, and
+    // end() returns one positioned past the largest, so that the elements
+    // can be visited with a range-based for loop, or passed to algorithms,
+    // in ascending order.  Each step follows child or parent links, with
+    // no recursion or stack, and takes amortized constant time.  Iterators
+    // remain valid until the AVLSet changes.
+    Iterator begin() const noexcept;
+    Iterator end() const noexcept;
+
+
+    // freeze() returns a FrozenOrderedSet containing the same elements,
+    // which is faster to search but slow to change (see FrozenOrderedSet.hpp).
+    // This function runs in O(n) time.
+    FrozenOrderedSet<ElementType> freeze() const;
+
+
     // preorder() calls the given "visit" function for each of the elements
     // in the set, in the order determined by a preorder traversal of the AVL
-    // tree.
+    // tree.  Like the other traversals, it follows the child and parent
+    // links without recursing, so it can traverse a tree of any height.
     void preorder(VisitFunction visit) const;
 
 
@@ -99,83 +252,146 @@ public:
 
 
 private:
-    // You'll no doubt want to add member variables and "helper" member
-    // functions here.
+    // An Index is the position of a node in the array of nodes.
+    using Index = std::uint32_t;
+
+    // NONE is the index of a missing child or parent.  It fits in the 30
+    // bits that a node has for its parent's index, so no tree can have
+    // more than NONE nodes (see checkRoomFor()).
+    static constexpr Index NONE = 0x3FFFFFFF;
+
     struct Node
     {
         ElementType value;
-        Node* left;
-        Node* right;
+        Index left;
+        Index right;
+
+        // The parent's index is stored in the low 30 bits, and the balance
+        // factor (the height of the right subtree minus the height of the
+        // left subtree), plus one, in the high 2 bits.  The balance factor
+        // is always -1, 0, or +1 when balancing is on, and 0 otherwise.
+        std::uint32_t parentAndBalance;
+
+        Index parent() const noexcept;
+        int balanceFactor() const noexcept;
+        void setParent(Index parent) noexcept;
+        void setBalanceFactor(int balanceFactor) noexcept;
     };
 
-    Node* root;
-    unsigned int sz;
+    std::vector<Node> nodes;
+    Index root;
+
+    // The height of the tree, which is only kept up to date when balancing
+    // is off.  (A balanced tree's height is found from balance factors.)
     int heightOfTree;
     bool balance;
 
-public:
-    void treeClear(Node* &newRoot);
-    void addHelper(const ElementType& element, Node* &t);
-    void preorderHelper(Node* &root, VisitFunction visit) const;
-    void inorderHelper(Node* &root, VisitFunction visit) const;
-    void postorderHelper(Node* &root, VisitFunction visit) const;
+    // Nodes that no longer belong to the tree (because split() moved their
+    // elements elsewhere) are linked together, through their left indices,
+    // to be reused before the array is made any longer.
+    Index freeNodes;
+    std::size_t freeCount;
+
+private:
+    void checkRoomFor(std::size_t additional) const;
+    Index allocateNode(const ElementType& element);
+    void releaseNode(Index node);
+    Index absorb(AVLSet& other);
+    void clear() noexcept;
+
+    bool retrace(Index child, Index& treeRoot);
+    void replaceChild(Index parent, Index oldChild, Index newChild, Index& treeRoot);
+    void setChildParent(Index child, Index parent);
+    Index linkSorted(Index first, Index last, Index parent, int& subtreeHeight);
+
+    Index joinNodes(Index left, int leftHeight, Index middle, Index right, int rightHeight, int& joinedHeight);
+
+    void splitNodes(
+        Index tree, int treeHeight, const ElementType& key,
+        Index& less, int& lessHeight, Index& rest, int& restHeight, Index* equal);
+
+    Index unionNodes(Index a, int aHeight, Index b, int bHeight, int& unionHeight);
+    int heightOf(Index subtree) const noexcept;
+
+    Index rotateLeft(Index x, Index z);
+    Index rotateRight(Index x, Index z);
+    Index rotateRightLeft(Index x, Index z);
+    Index rotateLeftRight(Index x, Index z);
+
+    Index leftmost(Index node) const;
+    Index firstInPostorder(Index node) const;
+    Index preorderSuccessor(Index node) const;
+    Index postorderSuccessor(Index node) const;
+
+    template <typename KeyType>
+    bool find(const KeyType& key) const;
+
+    template <typename KeyType>
+    Index lowerBoundIndex(const KeyType& key) const;
+
+    template <typename KeyType>
+    Index upperBoundIndex(const KeyType& key) const;
+
+    Index successor(Index node) const;
+    const ElementType* elementAt(Index node) const;
 };
 
 
+
 template <typename ElementType>
 AVLSet<ElementType>::AVLSet(bool shouldBalance)
-    : root{nullptr}, sz{0}, heightOfTree{-1}, balance{shouldBalance}
+    : root{NONE}, heightOfTree{-1}, balance{shouldBalance}, freeNodes{NONE}, freeCount{0}
 {
 }
 
+
 template <typename ElementType>
-AVLSet<ElementType>::~AVLSet() noexcept
+template <typename InputIterator, typename>
+AVLSet<ElementType>::AVLSet(InputIterator first, InputIterator last, bool shouldBalance)
+    : AVLSet{shouldBalance}
 {
-    treeClear(root);
-    sz = 0;
+    bulkLoad(first, last);
 }
 
 
 template <typename ElementType>
-void AVLSet<ElementType>::treeClear(Node* &newRoot)
+AVLSet<ElementType>::~AVLSet() noexcept
 {
-    if (newRoot != nullptr)
-    {
-        treeClear(newRoot->left);
-        treeClear(newRoot->right);
-        delete newRoot;
-    }
-    newRoot = nullptr;
+    // The nodes are all released by the vector.
 }
 
+
 template <typename ElementType>
 AVLSet<ElementType>::AVLSet(const AVLSet& s)
-   : root(s.root), sz{s.sz}, heightOfTree{-1}
+    : nodes{s.nodes}, root{s.root}, heightOfTree{s.heightOfTree}, balance{s.balance},
+      freeNodes{s.freeNodes}, freeCount{s.freeCount}
 {
+    // Since nodes refer to one another by index, copying the array copies
+    // the tree, shape and all, without walking it.
 }
 
 
 template <typename ElementType>
 AVLSet<ElementType>::AVLSet(AVLSet&& s) noexcept
+    : root{NONE}, heightOfTree{-1}, balance{s.balance}, freeNodes{NONE}, freeCount{0}
 {
-    root = nullptr;
-    sz = 0;
-    heightOfTree = -1;
-
+    std::swap(nodes, s.nodes);
     std::swap(root, s.root);
-    std::swap(sz, s.sz);
     std::swap(heightOfTree, s.heightOfTree);
+    std::swap(freeNodes, s.freeNodes);
+    std::swap(freeCount, s.freeCount);
 }
 
 
 template <typename ElementType>
 AVLSet<ElementType>& AVLSet<ElementType>::operator=(const AVLSet& s)
 {
-    AVLSet temp(s);
-    std::swap(root, temp.root);
-    std::swap(sz, temp.sz);
-    std::swap(heightOfTree, temp.heightOfTree);
-    
+    if (this != &s)
+    {
+        AVLSet temp(s);
+        *this = std::move(temp);
+    }
+
     return *this;
 }
 
@@ -183,10 +399,12 @@ AVLSet<ElementType>& AVLSet<ElementType>::operator=(const AVLSet& s)
 template <typename ElementType>
 AVLSet<ElementType>& AVLSet<ElementType>::operator=(AVLSet&& s) noexcept
 {
-    AVLSet temp(s);
-    std::swap(root, temp.root);
-    std::swap(sz, temp.sz);
-    std::swap(heightOfTree, temp.heightOfTree);
+    std::swap(nodes, s.nodes);
+    std::swap(root, s.root);
+    std::swap(heightOfTree, s.heightOfTree);
+    std::swap(balance, s.balance);
+    std::swap(freeNodes, s.freeNodes);
+    std::swap(freeCount, s.freeCount);
 
     return *this;
 }
@@ -202,162 +420,1377 @@ bool AVLSet<ElementType>::isImplemented() const noexcept
 template <typename ElementType>
 void AVLSet<ElementType>::add(const ElementType& element)
 {
-    addHelper(element, root);
-    sz++;
-}
+    Index parent = NONE;
+    bool isLeftChild = false;
+    int depth = 0;
 
-template <typename ElementType>
-void AVLSet<ElementType>::addHelper(const ElementType& element, Node* &t)
-{
-    if(t == nullptr)
+    for (Index current = root; current != NONE; ++depth)
     {
-        t = new Node;
-        t->value = element;
-        if(sz == 0)
+        parent = current;
+
+        if (element < nodes[current].value)
+        {
+            current = nodes[current].left;
+            isLeftChild = true;
+        }
+        else if (nodes[current].value < element)
         {
-            heightOfTree = 0;
+            current = nodes[current].right;
+            isLeftChild = false;
         }
         else
         {
-            heightOfTree++;
+            return;
         }
-        t->left = nullptr;
-        t->right = nullptr;
     }
-    else if(t->value > element)
+
+    // Adding the node may move the array, so no references into it are
+    // held across this.
+    Index node = allocateNode(element);
+    nodes[node].setParent(parent);
+    nodes[node].setBalanceFactor(0);
+
+    if (parent == NONE)
+    {
+        root = node;
+    }
+    else if (isLeftChild)
+    {
+        nodes[parent].left = node;
+    }
+    else
+    {
+        nodes[parent].right = node;
+    }
+
+    if (balance)
     {
-        addHelper(element, t->left);
+        retrace(node, root);
     }
-    else if(t->value < element)
+    else if (depth > heightOfTree)
     {
-        addHelper(element, t->right);
+        heightOfTree = depth;
     }
 }
 
+
 template <typename ElementType>
-bool AVLSet<ElementType>::contains(const ElementType& element) const
+template <typename InputIterator>
+void AVLSet<ElementType>::bulkLoad(InputIterator first, InputIterator last)
 {
-    Node* newNode = root;
-   
-    while(newNode != nullptr)
+    if (root == NONE && first != last)
     {
-        if(newNode->value == element)
+        clear();
+
+        using Category = typename std::iterator_traits<InputIterator>::iterator_category;
+
+        if constexpr (std::is_base_of_v<std::forward_iterator_tag, Category>)
         {
-            return true;
+            nodes.reserve(static_cast<std::size_t>(std::distance(first, last)));
         }
-        else if(newNode->value < element)
+
+        // The elements are placed into the array in ascending order, for as
+        // long as they arrive that way, then linked together.
+        for (; first != last; ++first)
         {
-            newNode = newNode->right;
+            const ElementType& element = *first;
+
+            if (!nodes.empty() && !(nodes.back().value < element))
+            {
+                if (element < nodes.back().value)
+                {
+                    break;
+                }
+
+                continue;
+            }
+
+            checkRoomFor(1);
+            nodes.push_back(Node{element, NONE, NONE, 0});
         }
-        else if(newNode->value > element)
+
+        int treeHeight;
+        root = linkSorted(0, static_cast<Index>(nodes.size()), NONE, treeHeight);
+
+        if (!balance)
         {
-            newNode = newNode->left;
+            heightOfTree = treeHeight;
         }
     }
-    return false;
+
+    for (; first != last; ++first)
+    {
+        add(*first);
+    }
 }
 
 
+// linkSorted() links the nodes in [first, last) of the array, whose elements
+// are in ascending order, into a perfectly balanced subtree with the middle
+// node as its root, returning the root and storing the subtree's height into
+// subtreeHeight.  The recursion is only as deep as the subtree is tall.
 template <typename ElementType>
-unsigned int AVLSet<ElementType>::size() const noexcept
+typename AVLSet<ElementType>::Index AVLSet<ElementType>::linkSorted(
+    Index first, Index last, Index parent, int& subtreeHeight)
+{
+    if (first == last)
+    {
+        subtreeHeight = -1;
+        return NONE;
+    }
+
+    Index middle = first + (last - first) / 2;
+    int leftHeight;
+    int rightHeight;
+
+    nodes[middle].left = linkSorted(first, middle, middle, leftHeight);
+    nodes[middle].right = linkSorted(middle + 1, last, middle, rightHeight);
+    nodes[middle].setParent(parent);
+    nodes[middle].setBalanceFactor(balance ? rightHeight - leftHeight : 0);
+
+    subtreeHeight = std::max(leftHeight, rightHeight) + 1;
+    return middle;
+}
+
+
+// checkRoomFor() throws a std::length_error unless the array has room for
+// the given number of additional nodes.  Past NONE nodes, a node's index
+// would be mistaken for a missing one, and wouldn't fit in its children's
+// parent fields, so the tree would silently be corrupted.
+template <typename ElementType>
+void AVLSet<ElementType>::checkRoomFor(std::size_t additional) const
 {
-    return sz;
+    if (additional > NONE - nodes.size())
+    {
+        throw std::length_error{"AVLSet cannot hold more than 2^30 - 1 elements"};
+    }
 }
 
 
+// retrace() walks from a node whose subtree has just grown one level taller
+// (a newly-added node, or one that joinNodes() has linked in) toward the
+// top of the tree whose root is treeRoot, updating the balance factors of
+// its ancestors, until it reaches a subtree whose height didn't change.  If
+// a subtree becomes unbalanced along the way, a single or double rotation
+// restores its balance, and almost always its original height, so nothing
+// above it needs to change; only when the taller child was itself evenly
+// balanced (which can happen after a join, but never after an addition)
+// is the rotated subtree still one level taller, so the walk continues.
+// retrace() returns true if the whole tree grew taller.
 template <typename ElementType>
-int AVLSet<ElementType>::height() const noexcept
+bool AVLSet<ElementType>::retrace(Index child, Index& treeRoot)
+{
+    for (Index parent = nodes[child].parent(); parent != NONE; parent = nodes[child].parent())
+    {
+        Node& p = nodes[parent];
+
+        if (child == p.right)
+        {
+            if (p.balanceFactor() > 0)
+            {
+                Index grandparent = p.parent();
+                Index subtree = nodes[child].balanceFactor() < 0
+                    ? rotateRightLeft(parent, child)
+                    : rotateLeft(parent, child);
+
+                replaceChild(grandparent, parent, subtree, treeRoot);
+
+                if (nodes[subtree].balanceFactor() == 0)
+                {
+                    return false;
+                }
+
+                child = subtree;
+                continue;
+            }
+            else if (p.balanceFactor() < 0)
+            {
+                p.setBalanceFactor(0);
+                return false;
+            }
+
+            p.setBalanceFactor(1);
+        }
+        else
+        {
+            if (p.balanceFactor() < 0)
+            {
+                Index grandparent = p.parent();
+                Index subtree = nodes[child].balanceFactor() > 0
+                    ? rotateLeftRight(parent, child)
+                    : rotateRight(parent, child);
+
+                replaceChild(grandparent, parent, subtree, treeRoot);
+
+                if (nodes[subtree].balanceFactor() == 0)
+                {
+                    return false;
+                }
+
+                child = subtree;
+                continue;
+            }
+            else if (p.balanceFactor() > 0)
+            {
+                p.setBalanceFactor(0);
+                return false;
+            }
+
+            p.setBalanceFactor(-1);
+        }
+
+        child = parent;
+    }
+
+    return true;
+}
+
+
+// replaceChild() makes newChild take oldChild's place as a child of the
+// given parent, or as the tree's root if the parent is NONE.
+template <typename ElementType>
+void AVLSet<ElementType>::replaceChild(Index parent, Index oldChild, Index newChild, Index& treeRoot)
 {
-    if(root == nullptr)
+    nodes[newChild].setParent(parent);
+
+    if (parent == NONE)
+    {
+        treeRoot = newChild;
+    }
+    else if (nodes[parent].left == oldChild)
     {
-        return -1;
+        nodes[parent].left = newChild;
     }
     else
     {
-        return heightOfTree;
+        nodes[parent].right = newChild;
     }
 }
 
 
+// setChildParent() sets the parent of the given child, if there is one.
 template <typename ElementType>
-void AVLSet<ElementType>::preorder(VisitFunction visit) const
+void AVLSet<ElementType>::setChildParent(Index child, Index parent)
 {
-    Node* newNode = root;
-    preorderHelper(newNode, visit);
+    if (child != NONE)
+    {
+        nodes[child].setParent(parent);
+    }
 }
 
+
+// rotateLeft() rotates the subtree rooted at x, whose right child z is two
+// levels taller than its left, and returns the subtree's new root (z).
+// The caller must attach the new root to x's former parent.
 template <typename ElementType>
-void AVLSet<ElementType>::preorderHelper(Node* &root, VisitFunction visit) const
+typename AVLSet<ElementType>::Index AVLSet<ElementType>::rotateLeft(Index x, Index z)
 {
-    if(root == nullptr)
+    Index inner = nodes[z].left;
+
+    nodes[x].right = inner;
+    setChildParent(inner, x);
+
+    nodes[z].left = x;
+    nodes[x].setParent(z);
+
+    if (nodes[z].balanceFactor() == 0)
+    {
+        nodes[x].setBalanceFactor(1);
+        nodes[z].setBalanceFactor(-1);
+    }
+    else
     {
+        nodes[x].setBalanceFactor(0);
+        nodes[z].setBalanceFactor(0);
+    }
+
+    return z;
+}
+
+
+// rotateRight() is the mirror image of rotateLeft(), where z is x's left
+// child.
+template <typename ElementType>
+typename AVLSet<ElementType>::Index AVLSet<ElementType>::rotateRight(Index x, Index z)
+{
+    Index inner = nodes[z].right;
 
+    nodes[x].left = inner;
+    setChildParent(inner, x);
+
+    nodes[z].right = x;
+    nodes[x].setParent(z);
+
+    if (nodes[z].balanceFactor() == 0)
+    {
+        nodes[x].setBalanceFactor(-1);
+        nodes[z].setBalanceFactor(1);
     }
     else
     {
-        Node* &newNode = root;
-        Node* lNode = root->left;
-        Node* rNode = rNode = root->right;
-        
-        visit(newNode->value);
-        preorderHelper(lNode, visit);
-        preorderHelper(rNode, visit);
+        nodes[x].setBalanceFactor(0);
+        nodes[z].setBalanceFactor(0);
     }
+
+    return z;
 }
 
 
+// rotateRightLeft() rotates the subtree rooted at x, whose right child z
+// is two levels taller than its left and is itself taller on the left, so
+// that z's left child y becomes the subtree's new root, which is returned.
 template <typename ElementType>
-void AVLSet<ElementType>::inorder(VisitFunction visit) const
+typename AVLSet<ElementType>::Index AVLSet<ElementType>::rotateRightLeft(Index x, Index z)
 {
-    Node* newNode = root;
-    inorderHelper(newNode, visit);
+    Index y = nodes[z].left;
+    Index yLeft = nodes[y].left;
+    Index yRight = nodes[y].right;
+    int yBalance = nodes[y].balanceFactor();
+
+    nodes[z].left = yRight;
+    setChildParent(yRight, z);
+
+    nodes[x].right = yLeft;
+    setChildParent(yLeft, x);
+
+    nodes[y].left = x;
+    nodes[y].right = z;
+    nodes[x].setParent(y);
+    nodes[z].setParent(y);
+
+    nodes[x].setBalanceFactor(yBalance > 0 ? -1 : 0);
+    nodes[z].setBalanceFactor(yBalance < 0 ? 1 : 0);
+    nodes[y].setBalanceFactor(0);
+
+    return y;
 }
 
+
+// rotateLeftRight() is the mirror image of rotateRightLeft(), where z is
+// x's left child and is taller on the right.
 template <typename ElementType>
-void AVLSet<ElementType>::inorderHelper(Node* &root, VisitFunction visit) const
+typename AVLSet<ElementType>::Index AVLSet<ElementType>::rotateLeftRight(Index x, Index z)
 {
-   if(root == nullptr)
-   {
-        
-   }
-   else
-   {
-        Node* &newNode = root;
-        Node* lNode = root->left;
-        Node* rNode = rNode = root->right;
+    Index y = nodes[z].right;
+    Index yLeft = nodes[y].left;
+    Index yRight = nodes[y].right;
+    int yBalance = nodes[y].balanceFactor();
+
+    nodes[z].right = yLeft;
+    setChildParent(yLeft, z);
 
-        inorderHelper(lNode, visit);
-        visit(newNode->value);
-        inorderHelper(rNode, visit);
+    nodes[x].left = yRight;
+    setChildParent(yRight, x);
 
-   }
+    nodes[y].left = z;
+    nodes[y].right = x;
+    nodes[x].setParent(y);
+    nodes[z].setParent(y);
+
+    nodes[x].setBalanceFactor(yBalance < 0 ? 1 : 0);
+    nodes[z].setBalanceFactor(yBalance > 0 ? -1 : 0);
+    nodes[y].setBalanceFactor(0);
+
+    return y;
 }
 
+
 template <typename ElementType>
-void AVLSet<ElementType>::postorder(VisitFunction visit) const
+bool AVLSet<ElementType>::contains(const ElementType& element) const
+{
+    return find(element);
+}
+
+
+template <typename ElementType>
+template <typename KeyType, typename>
+bool AVLSet<ElementType>::contains(const KeyType& key) const
 {
-    Node* newNode = root;
-    postorderHelper(newNode, visit);
+    return find(std::string_view{key});
 }
 
+
 template <typename ElementType>
-void AVLSet<ElementType>::postorderHelper(Node* &root, VisitFunction visit) const
+template <typename KeyType>
+bool AVLSet<ElementType>::find(const KeyType& key) const
 {
-    if(root == nullptr)
+    Index current = root;
+
+    while (current != NONE)
     {
+        const Node& node = nodes[current];
 
+        if (node.value == key)
+        {
+            return true;
+        }
+        else if (node.value < key)
+        {
+            current = node.right;
+        }
+        else
+        {
+            current = node.left;
+        }
     }
-    else
+
+    return false;
+}
+
+
+template <typename ElementType>
+const ElementType* AVLSet<ElementType>::lowerBound(const ElementType& key) const
+{
+    return elementAt(lowerBoundIndex(key));
+}
+
+
+template <typename ElementType>
+const ElementType* AVLSet<ElementType>::upperBound(const ElementType& key) const
+{
+    return elementAt(upperBoundIndex(key));
+}
+
+
+template <typename ElementType>
+template <typename KeyType, typename>
+const ElementType* AVLSet<ElementType>::lowerBound(const KeyType& key) const
+{
+    return elementAt(lowerBoundIndex(std::string_view{key}));
+}
+
+
+template <typename ElementType>
+template <typename KeyType, typename>
+const ElementType* AVLSet<ElementType>::upperBound(const KeyType& key) const
+{
+    return elementAt(upperBoundIndex(std::string_view{key}));
+}
+
+
+template <typename ElementType>
+void AVLSet<ElementType>::visitRange(const ElementType& low, const ElementType& high, VisitFunction visit) const
+{
+    for (Index node = lowerBoundIndex(low); node != NONE && nodes[node].value < high; node = successor(node))
     {
-        Node* &newNode = root;
-        Node* lNode = root->left;
-        Node* rNode = rNode = root->right;
+        visit(nodes[node].value);
+    }
+}
 
-        postorderHelper(lNode, visit);
-        postorderHelper(rNode, visit);
-        visit(newNode->value);
+
+template <typename ElementType>
+template <typename E, typename>
+void AVLSet<ElementType>::visitPrefix(std::string_view prefix, VisitFunction visit) const
+{
+    // The elements beginning with the prefix are consecutive, starting
+    // with the first that isn't less than the prefix itself.
+    for (Index node = lowerBoundIndex(prefix);
+         node != NONE && nodes[node].value.compare(0, prefix.size(), prefix) == 0;
+         node = successor(node))
+    {
+        visit(nodes[node].value);
     }
 }
 
-#endif
 
+template <typename ElementType>
+AVLSet<ElementType> AVLSet<ElementType>::split(const ElementType& key)
+{
+    AVLSet greater{balance};
+
+    if (!balance)
+    {
+        // Adding the elements in preorder makes each one's path a subset
+        // of its ancestors in this tree, so neither piece is any taller.
+        AVLSet less{false};
+
+        preorder(
+            [&](const ElementType& element)
+            {
+                (element < key ? less : greater).add(element);
+            });
+
+        *this = std::move(less);
+        return greater;
+    }
+
+    Index less;
+    int lessHeight;
+    Index rest;
+    int restHeight;
+
+    splitNodes(root, height(), key, less, lessHeight, rest, restHeight, nullptr);
+    root = less;
+
+    // The nodes holding the removed elements are moved, in preorder, into
+    // the new set's array, keeping the shape and balance factors they
+    // already have; the ones they leave behind are released for reuse.
+    struct Move
+    {
+        Index from;
+        Index parent;
+        bool isLeftChild;
+    };
+
+    std::vector<Move> pending;
+
+    if (rest != NONE)
+    {
+        pending.push_back(Move{rest, NONE, false});
+    }
+
+    while (!pending.empty())
+    {
+        Move move = pending.back();
+        pending.pop_back();
+
+        Node& from = nodes[move.from];
+        Index to = static_cast<Index>(greater.nodes.size());
+
+        greater.nodes.push_back(Node{std::move(from.value), NONE, NONE, 0});
+        greater.nodes[to].setParent(move.parent);
+        greater.nodes[to].setBalanceFactor(from.balanceFactor());
+
+        if (move.parent == NONE)
+        {
+            greater.root = to;
+        }
+        else if (move.isLeftChild)
+        {
+            greater.nodes[move.parent].left = to;
+        }
+        else
+        {
+            greater.nodes[move.parent].right = to;
+        }
+
+        if (from.right != NONE)
+        {
+            pending.push_back(Move{from.right, to, false});
+        }
+
+        if (from.left != NONE)
+        {
+            pending.push_back(Move{from.left, to, true});
+        }
+
+        releaseNode(move.from);
+    }
+
+    return greater;
+}
+
+
+template <typename ElementType>
+void AVLSet<ElementType>::join(AVLSet greater)
+{
+    if (greater.root == NONE)
+    {
+        return;
+    }
+    else if (!balance || !greater.balance)
+    {
+        unionWith(std::move(greater));
+        return;
+    }
+    else if (root == NONE)
+    {
+        *this = std::move(greater);
+        return;
+    }
+
+    Index largest = root;
+
+    while (nodes[largest].right != NONE)
+    {
+        largest = nodes[largest].right;
+    }
+
+    if (!(nodes[largest].value < greater.nodes[greater.leftmost(greater.root)].value))
+    {
+        unionWith(std::move(greater));
+        return;
+    }
+
+    // Whichever set is larger keeps its array, into which the other set's
+    // nodes are moved.
+    Index lessRoot;
+    Index greaterRoot;
+
+    if (greater.nodes.size() > nodes.size())
+    {
+        std::swap(*this, greater);
+        greaterRoot = root;
+        lessRoot = absorb(greater);
+    }
+    else
+    {
+        lessRoot = root;
+        greaterRoot = absorb(greater);
+    }
+
+    // The greater tree's smallest element is detached to be the middle
+    // node that joins the two trees.
+    int lessHeight = heightOf(lessRoot);
+    Index middle = leftmost(greaterRoot);
+    Index rest;
+    int restHeight;
+    Index none;
+    int noneHeight;
+
+    splitNodes(
+        greaterRoot, heightOf(greaterRoot), nodes[middle].value,
+        none, noneHeight, rest, restHeight, &middle);
+
+    int joinedHeight;
+    root = joinNodes(lessRoot, lessHeight, middle, rest, restHeight, joinedHeight);
+}
+
+
+template <typename ElementType>
+void AVLSet<ElementType>::unionWith(AVLSet other)
+{
+    if (!balance || !other.balance)
+    {
+        other.preorder(
+            [this](const ElementType& element)
+            {
+                add(element);
+            });
+
+        return;
+    }
+
+    // The smaller set's elements are the ones that split the larger tree,
+    // and its nodes are moved into the larger set's array.
+    if (other.size() > size())
+    {
+        std::swap(*this, other);
+    }
+
+    int thisHeight = height();
+    int otherHeight = other.height();
+    Index otherRoot = absorb(other);
+
+    int unionHeight;
+    root = unionNodes(root, thisHeight, otherRoot, otherHeight, unionHeight);
+}
+
+
+template <typename ElementType>
+template <typename RandomAccessIterator>
+AVLSet<ElementType> AVLSet<ElementType>::buildInParallel(
+    RandomAccessIterator first, RandomAccessIterator last, unsigned int threadCount)
+{
+    auto count = static_cast<std::size_t>(std::distance(first, last));
+    std::size_t pieceCount = std::min<std::size_t>(std::max(threadCount, 1u), std::max<std::size_t>(count, 1));
+
+    std::vector<AVLSet> pieces(pieceCount);
+    std::vector<std::thread> threads;
+
+    for (std::size_t i = 0; i < pieceCount; ++i)
+    {
+        threads.emplace_back(
+            [&pieces, first, count, pieceCount, i]
+            {
+                pieces[i].bulkLoad(first + count * i / pieceCount, first + count * (i + 1) / pieceCount);
+            });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    // Each round joins neighboring pieces together, each pair on its own
+    // thread, halving the number of pieces, so the order of the elements
+    // is kept and every join is cheap when the range was sorted.
+    for (std::size_t step = 1; step < pieceCount; step *= 2)
+    {
+        threads.clear();
+
+        for (std::size_t i = 0; i + step < pieceCount; i += 2 * step)
+        {
+            threads.emplace_back(
+                [&pieces, step, i]
+                {
+                    pieces[i].join(std::move(pieces[i + step]));
+                });
+        }
+
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    return std::move(pieces[0]);
+}
+
+
+template <typename ElementType>
+unsigned int AVLSet<ElementType>::size() const noexcept
+{
+    return static_cast<unsigned int>(nodes.size() - freeCount);
+}
+
+
+template <typename ElementType>
+int AVLSet<ElementType>::height() const noexcept
+{
+    return balance ? heightOf(root) : heightOfTree;
+}
+
+
+// heightOf() returns the height of the balanced subtree with the given root.
+// The longest path from the root always follows the taller child, which the
+// balance factors identify, so this takes O(log n) time.
+template <typename ElementType>
+int AVLSet<ElementType>::heightOf(Index subtree) const noexcept
+{
+    int subtreeHeight = -1;
+
+    for (Index current = subtree; current != NONE; )
+    {
+        ++subtreeHeight;
+        current = nodes[current].balanceFactor() > 0 ? nodes[current].right : nodes[current].left;
+    }
+
+    return subtreeHeight;
+}
+
+
+// allocateNode() returns the index of a node holding the given element and
+// no children, reusing a released node if there is one.  The caller sets
+// its parent and balance factor.
+template <typename ElementType>
+typename AVLSet<ElementType>::Index AVLSet<ElementType>::allocateNode(const ElementType& element)
+{
+    if (freeNodes == NONE)
+    {
+        checkRoomFor(1);
+        nodes.push_back(Node{element, NONE, NONE, 0});
+        return static_cast<Index>(nodes.size() - 1);
+    }
+
+    Index node = freeNodes;
+    freeNodes = nodes[node].left;
+    --freeCount;
+
+    nodes[node].value = element;
+    nodes[node].left = NONE;
+    nodes[node].right = NONE;
+    return node;
+}
+
+
+// releaseNode() puts a node that is no longer in the tree onto the free
+// list, releasing whatever its element owns.
+template <typename ElementType>
+void AVLSet<ElementType>::releaseNode(Index node)
+{
+    nodes[node].value = ElementType{};
+    nodes[node].left = freeNodes;
+    nodes[node].right = NONE;
+    freeNodes = node;
+    ++freeCount;
+}
+
+
+// absorb() moves all of the other AVLSet's nodes, including its free ones,
+// onto the end of this one's array, leaving the other set empty, and
+// returns the index that the other set's root now has.  The other set's
+// tree isn't linked into this one's; that's left to the caller.
+template <typename ElementType>
+typename AVLSet<ElementType>::Index AVLSet<ElementType>::absorb(AVLSet& other)
+{
+    auto offset = static_cast<Index>(nodes.size());
+
+    auto moved = [offset](Index index)
+    {
+        return index == NONE ? NONE : index + offset;
+    };
+
+    checkRoomFor(other.nodes.size());
+    nodes.reserve(nodes.size() + other.nodes.size());
+
+    for (Node& node : other.nodes)
+    {
+        nodes.push_back(Node{std::move(node.value), moved(node.left), moved(node.right), 0});
+        nodes.back().setParent(moved(node.parent()));
+        nodes.back().setBalanceFactor(node.balanceFactor());
+    }
+
+    // The other set's free list is put in front of this one's.
+    if (other.freeNodes != NONE)
+    {
+        Index lastFree = moved(other.freeNodes);
+
+        while (nodes[lastFree].left != NONE)
+        {
+            lastFree = nodes[lastFree].left;
+        }
+
+        nodes[lastFree].left = freeNodes;
+        freeNodes = moved(other.freeNodes);
+        freeCount += other.freeCount;
+    }
+
+    Index otherRoot = moved(other.root);
+    other.clear();
+    return otherRoot;
+}
+
+
+// clear() removes all of the nodes, leaving the tree empty.
+template <typename ElementType>
+void AVLSet<ElementType>::clear() noexcept
+{
+    nodes.clear();
+    root = NONE;
+    heightOfTree = -1;
+    freeNodes = NONE;
+    freeCount = 0;
+}
+
+
+// joinNodes() links the balanced subtrees "left" and "right" (either of
+// which may be empty) as the children of the detached node "middle,"
+// given that every element of "left" is less than middle's, which is less
+// than every element of "right."  If the subtrees' heights differ by more
+// than one, middle is linked in at the point along the taller subtree's
+// inner spine where the shorter one fits, then the taller one is retraced
+// upward from there, as after an addition, which takes time proportional
+// to the difference in heights.  The new root is returned, and its height
+// is stored into joinedHeight.
+template <typename ElementType>
+typename AVLSet<ElementType>::Index AVLSet<ElementType>::joinNodes(
+    Index left, int leftHeight, Index middle, Index right, int rightHeight, int& joinedHeight)
+{
+    setChildParent(left, NONE);
+    setChildParent(right, NONE);
+
+    if (leftHeight > rightHeight + 1)
+    {
+        Index parent = NONE;
+        Index current = left;
+        int currentHeight = leftHeight;
+
+        while (currentHeight > rightHeight + 1)
+        {
+            currentHeight -= nodes[current].balanceFactor() < 0 ? 2 : 1;
+            parent = current;
+            current = nodes[current].right;
+        }
+
+        nodes[middle].left = current;
+        nodes[middle].right = right;
+        nodes[middle].setParent(parent);
+        nodes[middle].setBalanceFactor(rightHeight - currentHeight);
+        setChildParent(current, middle);
+        setChildParent(right, middle);
+        nodes[parent].right = middle;
+
+        joinedHeight = leftHeight + (retrace(middle, left) ? 1 : 0);
+        return left;
+    }
+    else if (rightHeight > leftHeight + 1)
+    {
+        Index parent = NONE;
+        Index current = right;
+        int currentHeight = rightHeight;
+
+        while (currentHeight > leftHeight + 1)
+        {
+            currentHeight -= nodes[current].balanceFactor() > 0 ? 2 : 1;
+            parent = current;
+            current = nodes[current].left;
+        }
+
+        nodes[middle].left = left;
+        nodes[middle].right = current;
+        nodes[middle].setParent(parent);
+        nodes[middle].setBalanceFactor(currentHeight - leftHeight);
+        setChildParent(left, middle);
+        setChildParent(current, middle);
+        nodes[parent].left = middle;
+
+        joinedHeight = rightHeight + (retrace(middle, right) ? 1 : 0);
+        return right;
+    }
+
+    nodes[middle].left = left;
+    nodes[middle].right = right;
+    nodes[middle].setParent(NONE);
+    nodes[middle].setBalanceFactor(rightHeight - leftHeight);
+    setChildParent(left, middle);
+    setChildParent(right, middle);
+
+    joinedHeight = std::max(leftHeight, rightHeight) + 1;
+    return middle;
+}
+
+
+// splitNodes() takes apart the balanced subtree rooted at "tree," whose
+// height is treeHeight, into a subtree of the elements less than the key
+// and a subtree of the rest, storing their roots and heights.  If "equal"
+// isn't nullptr, a node holding an element equal to the key is left out of
+// both subtrees and its index stored into *equal; otherwise, it's part of
+// the rest.  Along the path to the key, each node is detached, then joined
+// with the pieces on either side of it, so this takes O(log n) time.
+template <typename ElementType>
+void AVLSet<ElementType>::splitNodes(
+    Index tree, int treeHeight, const ElementType& key,
+    Index& less, int& lessHeight, Index& rest, int& restHeight, Index* equal)
+{
+    if (tree == NONE)
+    {
+        less = NONE;
+        lessHeight = -1;
+        rest = NONE;
+        restHeight = -1;
+        return;
+    }
+
+    Node& node = nodes[tree];
+    Index left = node.left;
+    Index right = node.right;
+    int leftHeight = treeHeight - (node.balanceFactor() > 0 ? 2 : 1);
+    int rightHeight = treeHeight - (node.balanceFactor() < 0 ? 2 : 1);
+
+    node.left = NONE;
+    node.right = NONE;
+
+    if (key < node.value)
+    {
+        Index middleRest;
+        int middleRestHeight;
+
+        splitNodes(left, leftHeight, key, less, lessHeight, middleRest, middleRestHeight, equal);
+        rest = joinNodes(middleRest, middleRestHeight, tree, right, rightHeight, restHeight);
+    }
+    else if (node.value < key)
+    {
+        Index middleLess;
+        int middleLessHeight;
+
+        splitNodes(right, rightHeight, key, middleLess, middleLessHeight, rest, restHeight, equal);
+        less = joinNodes(left, leftHeight, tree, middleLess, middleLessHeight, lessHeight);
+    }
+    else
+    {
+        setChildParent(left, NONE);
+        less = left;
+        lessHeight = leftHeight;
+
+        if (equal != nullptr)
+        {
+            setChildParent(right, NONE);
+            nodes[tree].setParent(NONE);
+            *equal = tree;
+            rest = right;
+            restHeight = rightHeight;
+        }
+        else
+        {
+            rest = joinNodes(NONE, -1, tree, right, rightHeight, restHeight);
+        }
+    }
+}
+
+
+// unionNodes() merges the balanced subtrees rooted at a and b, whose heights
+// are given, returning the merged subtree's root and storing its height
+// into unionHeight.  The root of b splits a into the elements less than
+// it and the rest (any equal node of a's being released), then each piece
+// of a is merged with the corresponding child of b's root and the results
+// are joined under it.
+template <typename ElementType>
+typename AVLSet<ElementType>::Index AVLSet<ElementType>::unionNodes(
+    Index a, int aHeight, Index b, int bHeight, int& unionHeight)
+{
+    if (a == NONE || b == NONE)
+    {
+        Index nonempty = a == NONE ? b : a;
+        setChildParent(nonempty, NONE);
+        unionHeight = a == NONE ? bHeight : aHeight;
+        return nonempty;
+    }
+
+    Node& node = nodes[b];
+    Index bLeft = node.left;
+    Index bRight = node.right;
+    int bLeftHeight = bHeight - (node.balanceFactor() > 0 ? 2 : 1);
+    int bRightHeight = bHeight - (node.balanceFactor() < 0 ? 2 : 1);
+
+    node.left = NONE;
+    node.right = NONE;
+
+    Index aLess;
+    int aLessHeight;
+    Index aRest;
+    int aRestHeight;
+    Index duplicate = NONE;
+
+    splitNodes(a, aHeight, nodes[b].value, aLess, aLessHeight, aRest, aRestHeight, &duplicate);
+
+    if (duplicate != NONE)
+    {
+        releaseNode(duplicate);
+    }
+
+    int leftHeight;
+    Index left = unionNodes(aLess, aLessHeight, bLeft, bLeftHeight, leftHeight);
+
+    int rightHeight;
+    Index right = unionNodes(aRest, aRestHeight, bRight, bRightHeight, rightHeight);
+
+    return joinNodes(left, leftHeight, b, right, rightHeight, unionHeight);
+}
+
+
+// lowerBoundIndex() returns the index of the node holding the smallest
+// element that is not less than the given key, or NONE if there is none.
+template <typename ElementType>
+template <typename KeyType>
+typename AVLSet<ElementType>::Index AVLSet<ElementType>::lowerBoundIndex(const KeyType& key) const
+{
+    Index bound = NONE;
+
+    for (Index current = root; current != NONE; )
+    {
+        if (nodes[current].value < key)
+        {
+            current = nodes[current].right;
+        }
+        else
+        {
+            bound = current;
+            current = nodes[current].left;
+        }
+    }
+
+    return bound;
+}
+
+
+// upperBoundIndex() returns the index of the node holding the smallest
+// element that is greater than the given key, or NONE if there is none.
+template <typename ElementType>
+template <typename KeyType>
+typename AVLSet<ElementType>::Index AVLSet<ElementType>::upperBoundIndex(const KeyType& key) const
+{
+    Index bound = NONE;
+
+    for (Index current = root; current != NONE; )
+    {
+        if (key < nodes[current].value)
+        {
+            bound = current;
+            current = nodes[current].left;
+        }
+        else
+        {
+            current = nodes[current].right;
+        }
+    }
+
+    return bound;
+}
+
+
+// successor() returns the index of the node holding the next larger
+// element, or NONE if the given node holds the largest.  Following the
+// successors from one node to the next visits each edge of the tree at
+// most twice, so visiting k consecutive elements takes O(log n + k) time.
+template <typename ElementType>
+typename AVLSet<ElementType>::Index AVLSet<ElementType>::successor(Index node) const
+{
+    if (nodes[node].right != NONE)
+    {
+        node = nodes[node].right;
+
+        while (nodes[node].left != NONE)
+        {
+            node = nodes[node].left;
+        }
+
+        return node;
+    }
+
+    Index parent = nodes[node].parent();
+
+    while (parent != NONE && nodes[parent].right == node)
+    {
+        node = parent;
+        parent = nodes[node].parent();
+    }
+
+    return parent;
+}
+
+
+template <typename ElementType>
+const ElementType* AVLSet<ElementType>::elementAt(Index node) const
+{
+    return node == NONE ? nullptr : &nodes[node].value;
+}
+
+
+template <typename ElementType>
+typename AVLSet<ElementType>::Iterator AVLSet<ElementType>::begin() const noexcept
+{
+    return Iterator{this, root == NONE ? NONE : leftmost(root)};
+}
+
+
+template <typename ElementType>
+typename AVLSet<ElementType>::Iterator AVLSet<ElementType>::end() const noexcept
+{
+    return Iterator{this, NONE};
+}
+
+
+template <typename ElementType>
+FrozenOrderedSet<ElementType> AVLSet<ElementType>::freeze() const
+{
+    return FrozenOrderedSet<ElementType>{begin(), end()};
+}
+
+
+template <typename ElementType>
+void AVLSet<ElementType>::preorder(VisitFunction visit) const
+{
+    for (Index node = root; node != NONE; node = preorderSuccessor(node))
+    {
+        visit(nodes[node].value);
+    }
+}
+
+
+template <typename ElementType>
+void AVLSet<ElementType>::inorder(VisitFunction visit) const
+{
+    for (const ElementType& element : *this)
+    {
+        visit(element);
+    }
+}
+
+
+template <typename ElementType>
+void AVLSet<ElementType>::postorder(VisitFunction visit) const
+{
+    for (Index node = firstInPostorder(root); node != NONE; node = postorderSuccessor(node))
+    {
+        visit(nodes[node].value);
+    }
+}
+
+
+// leftmost() returns the node holding the smallest element in the subtree
+// rooted at the given node.
+template <typename ElementType>
+typename AVLSet<ElementType>::Index AVLSet<ElementType>::leftmost(Index node) const
+{
+    while (nodes[node].left != NONE)
+    {
+        node = nodes[node].left;
+    }
+
+    return node;
+}
+
+
+// firstInPostorder() returns the node that a postorder traversal of the
+// subtree rooted at the given node visits first: the leaf reached by
+// going left whenever possible and right otherwise.
+template <typename ElementType>
+typename AVLSet<ElementType>::Index AVLSet<ElementType>::firstInPostorder(Index node) const
+{
+    while (node != NONE)
+    {
+        if (nodes[node].left != NONE)
+        {
+            node = nodes[node].left;
+        }
+        else if (nodes[node].right != NONE)
+        {
+            node = nodes[node].right;
+        }
+        else
+        {
+            return node;
+        }
+    }
+
+    return NONE;
+}
+
+
+// preorderSuccessor() returns the node that a preorder traversal visits
+// after the given one, or NONE if it's the last.  After a leaf comes the
+// right child of the nearest ancestor whose left subtree was just finished.
+template <typename ElementType>
+typename AVLSet<ElementType>::Index AVLSet<ElementType>::preorderSuccessor(Index node) const
+{
+    if (nodes[node].left != NONE)
+    {
+        return nodes[node].left;
+    }
+    else if (nodes[node].right != NONE)
+    {
+        return nodes[node].right;
+    }
+
+    for (Index parent = nodes[node].parent(); parent != NONE; node = parent, parent = nodes[node].parent())
+    {
+        if (nodes[parent].left == node && nodes[parent].right != NONE)
+        {
+            return nodes[parent].right;
+        }
+    }
+
+    return NONE;
+}
+
+
+// postorderSuccessor() returns the node that a postorder traversal visits
+// after the given one, or NONE if it's the last.  After a left child comes
+// its sibling's subtree, if there is one; otherwise, the parent is next.
+template <typename ElementType>
+typename AVLSet<ElementType>::Index AVLSet<ElementType>::postorderSuccessor(Index node) const
+{
+    Index parent = nodes[node].parent();
+
+    if (parent != NONE && nodes[parent].left == node && nodes[parent].right != NONE)
+    {
+        return firstInPostorder(nodes[parent].right);
+    }
+
+    return parent;
+}
+
+
+template <typename ElementType>
+typename AVLSet<ElementType>::Index AVLSet<ElementType>::Node::parent() const noexcept
+{
+    return parentAndBalance & NONE;
+}
+
+
+template <typename ElementType>
+int AVLSet<ElementType>::Node::balanceFactor() const noexcept
+{
+    return static_cast<int>(parentAndBalance >> 30) - 1;
+}
+
+
+template <typename ElementType>
+void AVLSet<ElementType>::Node::setParent(Index parent) noexcept
+{
+    parentAndBalance = (parentAndBalance & ~NONE) | parent;
+}
+
+
+template <typename ElementType>
+void AVLSet<ElementType>::Node::setBalanceFactor(int balanceFactor) noexcept
+{
+    parentAndBalance = (parentAndBalance & NONE) | (static_cast<std::uint32_t>(balanceFactor + 1) << 30);
+}
+
+
+
+template <typename ElementType>
+class AVLSet<ElementType>::Iterator
+{
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = ElementType;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const ElementType*;
+    using reference = const ElementType&;
+
+public:
+    // Initializes an Iterator that isn't positioned in any AVLSet.
+    Iterator() noexcept;
+
+    reference operator*() const noexcept;
+    pointer operator->() const noexcept;
+
+    Iterator& operator++();
+    Iterator operator++(int);
+
+    bool operator==(const Iterator& other) const noexcept;
+    bool operator!=(const Iterator& other) const noexcept;
+
+private:
+    friend class AVLSet;
+    Iterator(const AVLSet* set, Index node) noexcept;
+
+    const AVLSet* set;
+    Index node;
+};
+
+
+template <typename ElementType>
+AVLSet<ElementType>::Iterator::Iterator() noexcept
+    : set{nullptr}, node{NONE}
+{
+}
+
+
+template <typename ElementType>
+AVLSet<ElementType>::Iterator::Iterator(const AVLSet* set, Index node) noexcept
+    : set{set}, node{node}
+{
+}
+
+
+template <typename ElementType>
+const ElementType& AVLSet<ElementType>::Iterator::operator*() const noexcept
+{
+    return set->nodes[node].value;
+}
+
+
+template <typename ElementType>
+const ElementType* AVLSet<ElementType>::Iterator::operator->() const noexcept
+{
+    return &set->nodes[node].value;
+}
+
+
+template <typename ElementType>
+typename AVLSet<ElementType>::Iterator& AVLSet<ElementType>::Iterator::operator++()
+{
+    node = set->successor(node);
+    return *this;
+}
+
+
+template <typename ElementType>
+typename AVLSet<ElementType>::Iterator AVLSet<ElementType>::Iterator::operator++(int)
+{
+    Iterator previous = *this;
+    ++*this;
+    return previous;
+}
+
+
+template <typename ElementType>
+bool AVLSet<ElementType>::Iterator::operator==(const Iterator& other) const noexcept
+{
+    return node == other.node;
+}
+
+
+template <typename ElementType>
+bool AVLSet<ElementType>::Iterator::operator!=(const Iterator& other) const noexcept
+{
+    return node != other.node;
+}
+
+
+
+#endif
@@ -0,0 +1,546 @@
+// AVLSet_ExtendedTests.cpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// These unit tests go beyond the sanity-checking tests, exercising the
+// parts of the AVLSet implementation that the sanity-checking tests
+// don't reach.
+
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <gtest/gtest.h>
+#include "AVLSet.hpp"
+
+
+TEST(AVLSet_ExtendedTests, canSearchForStringViews)
+{
+    AVLSet<std::string> s;
+    s.add("BOO");
+    s.add("HELLO");
+    s.add("THERE");
+
+    std::string_view text{"SAY HELLO THERE"};
+
+    EXPECT_TRUE(s.contains(text.substr(4, 5)));
+    EXPECT_TRUE(s.contains(text.substr(10)));
+    EXPECT_FALSE(s.contains(text.substr(0, 3)));
+    EXPECT_TRUE(s.contains("BOO"));
+}
+
+
+TEST(AVLSet_ExtendedTests, copiesAreIndependent)
+{
+    AVLSet<std::string> s1;
+    s1.add("HELLO");
+    s1.add("BOO");
+    s1.add("THERE");
+
+    AVLSet<std::string> s2{s1};
+    s2.add("PERSON");
+
+    EXPECT_TRUE(s2.contains("HELLO"));
+    EXPECT_TRUE(s2.contains("PERSON"));
+    EXPECT_FALSE(s1.contains("PERSON"));
+
+    std::vector<std::string> elements;
+    s2.preorder([&](const std::string& element) { elements.push_back(element); });
+
+    std::vector<std::string> expected{"HELLO", "BOO", "THERE", "PERSON"};
+    EXPECT_EQ(expected, elements);
+
+    AVLSet<std::string> s3;
+    s3 = s2;
+    EXPECT_TRUE(s3.contains("PERSON"));
+
+    AVLSet<std::string> s4{std::move(s3)};
+    EXPECT_TRUE(s4.contains("THERE"));
+}
+
+
+TEST(AVLSet_ExtendedTests, addingDuplicatesDoesNotChangeSize)
+{
+    AVLSet<int> s;
+    s.add(5);
+    s.add(3);
+    s.add(5);
+    s.add(3);
+
+    EXPECT_EQ(2, s.size());
+    EXPECT_EQ(1, s.height());
+}
+
+
+TEST(AVLSet_ExtendedTests, sortedAdditionsStayBalanced)
+{
+    AVLSet<int> s;
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        s.add(i);
+    }
+
+    // A complete tree holding 2^17 - 1 elements has height 16.
+    EXPECT_EQ(100000, s.size());
+    EXPECT_EQ(16, s.height());
+
+    for (int i = 0; i < 100000; i += 997)
+    {
+        ASSERT_TRUE(s.contains(i));
+    }
+
+    EXPECT_FALSE(s.contains(100000));
+}
+
+
+TEST(AVLSet_ExtendedTests, everyRotationKeepsTheTreeInOrder)
+{
+    // Alternating between the ends and the middle of a range causes single
+    // and double rotations in both directions.
+    AVLSet<int> s;
+    std::vector<int> added;
+
+    for (int i = 0; i < 500; ++i)
+    {
+        int element = (i % 4 == 0) ? i : (i % 4 == 1) ? -i : (i % 4 == 2) ? 1000 - i : i / 2 + 2000;
+        s.add(element);
+        added.push_back(element);
+    }
+
+    std::sort(added.begin(), added.end());
+    added.erase(std::unique(added.begin(), added.end()), added.end());
+
+    std::vector<int> elements;
+    s.inorder([&](const int& element) { elements.push_back(element); });
+
+    EXPECT_EQ(added, elements);
+    EXPECT_EQ(added.size(), s.size());
+
+    // An AVL tree with n elements is never taller than 1.44 log2(n + 2).
+    EXPECT_LE(s.height(), 12);
+}
+
+
+TEST(AVLSet_ExtendedTests, unbalancedTreesCanBeVeryDeep)
+{
+    AVLSet<int> s{false};
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        s.add(i);
+    }
+
+    EXPECT_EQ(9999, s.height());
+    EXPECT_TRUE(s.contains(9999));
+
+    AVLSet<int> copy{s};
+    EXPECT_EQ(9999, copy.height());
+    EXPECT_TRUE(copy.contains(0));
+}
+
+
+TEST(AVLSet_ExtendedTests, sortedRangesAreBuiltPerfectlyBalanced)
+{
+    std::vector<int> elements{1, 2, 2, 3, 4, 5, 6, 6, 6, 7};
+    AVLSet<int> s{elements.begin(), elements.end()};
+
+    std::vector<int> preorder;
+    s.preorder([&](const int& element) { preorder.push_back(element); });
+
+    std::vector<int> expected{4, 2, 1, 3, 6, 5, 7};
+    EXPECT_EQ(expected, preorder);
+    EXPECT_EQ(7, s.size());
+    EXPECT_EQ(2, s.height());
+
+    // The balance factors are right, so later additions rebalance properly.
+    for (int i = 8; i <= 15; ++i)
+    {
+        s.add(i);
+    }
+
+    EXPECT_EQ(3, s.height());
+}
+
+
+TEST(AVLSet_ExtendedTests, largeSortedRangesAreBuiltWithoutBalancing)
+{
+    std::vector<int> elements;
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        elements.push_back(i);
+    }
+
+    AVLSet<int> s{elements.begin(), elements.end(), false};
+
+    EXPECT_EQ(100000, s.size());
+    EXPECT_EQ(16, s.height());
+    EXPECT_TRUE(s.contains(0));
+    EXPECT_TRUE(s.contains(99999));
+
+    // The rightmost path of this tree is shorter than its height, so the
+    // new largest element doesn't make it taller.
+    s.add(100000);
+    EXPECT_TRUE(s.contains(100000));
+    EXPECT_EQ(16, s.height());
+}
+
+
+TEST(AVLSet_ExtendedTests, unsortedRangesAreAddedOneAtATime)
+{
+    std::istringstream in{"10 20 30 25 5 40 30"};
+    AVLSet<int> s{std::istream_iterator<int>{in}, std::istream_iterator<int>{}};
+
+    std::vector<int> inorder;
+    s.inorder([&](const int& element) { inorder.push_back(element); });
+
+    std::vector<int> expected{5, 10, 20, 25, 30, 40};
+    EXPECT_EQ(expected, inorder);
+    EXPECT_EQ(6, s.size());
+    EXPECT_EQ(2, s.height());
+
+    // Loading into a set that isn't empty adds each element.
+    std::vector<std::string> more{"1", "2", "3"};
+    AVLSet<std::string> t;
+    t.add("2");
+    t.bulkLoad(more.begin(), more.end());
+    EXPECT_EQ(3, t.size());
+    EXPECT_EQ(1, t.height());
+}
+
+
+TEST(AVLSet_ExtendedTests, canFindBounds)
+{
+    AVLSet<int> s;
+
+    for (int i = 10; i <= 100; i += 10)
+    {
+        s.add(i);
+    }
+
+    ASSERT_NE(nullptr, s.lowerBound(30));
+    EXPECT_EQ(30, *s.lowerBound(30));
+    EXPECT_EQ(40, *s.upperBound(30));
+    EXPECT_EQ(40, *s.lowerBound(35));
+    EXPECT_EQ(40, *s.upperBound(35));
+    EXPECT_EQ(10, *s.lowerBound(-5));
+    EXPECT_EQ(100, *s.lowerBound(100));
+    EXPECT_EQ(nullptr, s.upperBound(100));
+    EXPECT_EQ(nullptr, s.lowerBound(101));
+
+    AVLSet<int> empty;
+    EXPECT_EQ(nullptr, empty.lowerBound(0));
+}
+
+
+TEST(AVLSet_ExtendedTests, canVisitRanges)
+{
+    AVLSet<int> s{false};
+
+    for (int i : {50, 20, 80, 10, 30, 70, 90, 60, 40})
+    {
+        s.add(i);
+    }
+
+    std::vector<int> elements;
+    s.visitRange(25, 75, [&](const int& element) { elements.push_back(element); });
+
+    std::vector<int> expected{30, 40, 50, 60, 70};
+    EXPECT_EQ(expected, elements);
+
+    elements.clear();
+    s.visitRange(0, 10, [&](const int& element) { elements.push_back(element); });
+    EXPECT_TRUE(elements.empty());
+
+    s.visitRange(85, 1000, [&](const int& element) { elements.push_back(element); });
+    EXPECT_EQ(std::vector<int>{90}, elements);
+}
+
+
+TEST(AVLSet_ExtendedTests, canVisitElementsWithPrefix)
+{
+    std::vector<std::string> words{
+        "RECEDE", "RECEIPT", "RECEIVE", "RECEIVED", "RECEIVER", "RECENT", "RECIPE", "REC"
+    };
+
+    AVLSet<std::string> s;
+
+    for (const std::string& word : words)
+    {
+        s.add(word);
+    }
+
+    std::vector<std::string> elements;
+    s.visitPrefix("RECEI", [&](const std::string& element) { elements.push_back(element); });
+
+    std::vector<std::string> expected{"RECEIPT", "RECEIVE", "RECEIVED", "RECEIVER"};
+    EXPECT_EQ(expected, elements);
+
+    elements.clear();
+    s.visitPrefix("REC", [&](const std::string& element) { elements.push_back(element); });
+    EXPECT_EQ(words.size(), elements.size());
+
+    elements.clear();
+    s.visitPrefix("RECX", [&](const std::string& element) { elements.push_back(element); });
+    EXPECT_TRUE(elements.empty());
+
+    std::string_view text{"RECEIVED"};
+    EXPECT_EQ("RECEIVE", *s.lowerBound(text.substr(0, 7)));
+    EXPECT_EQ("RECEIVED", *s.upperBound(text.substr(0, 7)));
+}
+
+
+TEST(AVLSet_ExtendedTests, canIterateInAscendingOrder)
+{
+    AVLSet<std::string> s;
+
+    for (const char* word : {"MANGO", "APPLE", "PEAR", "FIG", "KIWI", "BANANA"})
+    {
+        s.add(word);
+    }
+
+    std::vector<std::string> elements;
+
+    for (const std::string& element : s)
+    {
+        elements.push_back(element);
+    }
+
+    std::vector<std::string> expected{"APPLE", "BANANA", "FIG", "KIWI", "MANGO", "PEAR"};
+    EXPECT_EQ(expected, elements);
+
+    EXPECT_EQ(6, std::distance(s.begin(), s.end()));
+    EXPECT_EQ(5, s.begin()->length());
+    EXPECT_TRUE(std::is_sorted(s.begin(), s.end()));
+
+    AVLSet<int> empty;
+    EXPECT_TRUE(empty.begin() == empty.end());
+}
+
+
+TEST(AVLSet_ExtendedTests, traversalsMatchTheShapeOfTheTree)
+{
+    AVLSet<int> s{false};
+
+    for (int i : {50, 20, 80, 10, 30, 70, 90, 25, 75, 95})
+    {
+        s.add(i);
+    }
+
+    std::vector<int> preElements;
+    std::vector<int> inElements;
+    std::vector<int> postElements;
+
+    s.preorder([&](const int& element) { preElements.push_back(element); });
+    s.inorder([&](const int& element) { inElements.push_back(element); });
+    s.postorder([&](const int& element) { postElements.push_back(element); });
+
+    std::vector<int> expectedPreElements{50, 20, 10, 30, 25, 80, 70, 75, 90, 95};
+    std::vector<int> expectedInElements{10, 20, 25, 30, 50, 70, 75, 80, 90, 95};
+    std::vector<int> expectedPostElements{10, 25, 30, 20, 75, 70, 95, 90, 80, 50};
+
+    EXPECT_EQ(expectedPreElements, preElements);
+    EXPECT_EQ(expectedInElements, inElements);
+    EXPECT_EQ(expectedPostElements, postElements);
+}
+
+
+TEST(AVLSet_ExtendedTests, canTraverseVeryDeepTrees)
+{
+    AVLSet<int> s{false};
+
+    for (int i = 10000; i > 0; --i)
+    {
+        s.add(i);
+    }
+
+    long long preSum = 0;
+    long long postSum = 0;
+    int previous = 0;
+    bool ascending = true;
+
+    s.preorder([&](const int& element) { preSum += element; });
+    s.postorder([&](const int& element) { postSum += element; });
+    s.inorder([&](const int& element) { ascending = ascending && previous < element; previous = element; });
+
+    EXPECT_EQ(50005000LL, preSum);
+    EXPECT_EQ(50005000LL, postSum);
+    EXPECT_TRUE(ascending);
+}
+
+
+TEST(AVLSet_ExtendedTests, splitSeparatesSmallerElementsFromTheRest)
+{
+    AVLSet<int> s;
+
+    for (int i = 0; i < 1000; i += 2)
+    {
+        s.add(i);
+    }
+
+    AVLSet<int> greater = s.split(301);
+
+    EXPECT_EQ(151, s.size());
+    EXPECT_EQ(349, greater.size());
+    EXPECT_EQ(nullptr, s.upperBound(300));
+    EXPECT_EQ(302, *greater.begin());
+    EXPECT_TRUE(std::is_sorted(s.begin(), s.end()));
+    EXPECT_TRUE(std::is_sorted(greater.begin(), greater.end()));
+
+    AVLSet<int> equal = greater.split(302);
+
+    EXPECT_EQ(0, greater.size());
+    EXPECT_EQ(349, equal.size());
+    EXPECT_TRUE(equal.contains(302));
+}
+
+
+TEST(AVLSet_ExtendedTests, addingAfterASplitReusesNodes)
+{
+    AVLSet<int> s;
+
+    for (int i = 0; i < 100; ++i)
+    {
+        s.add(i);
+    }
+
+    AVLSet<int> greater = s.split(50);
+
+    for (int i = 100; i < 150; ++i)
+    {
+        s.add(i);
+    }
+
+    EXPECT_EQ(100, s.size());
+    EXPECT_FALSE(s.contains(50));
+    EXPECT_TRUE(s.contains(49));
+    EXPECT_TRUE(s.contains(149));
+    EXPECT_TRUE(std::is_sorted(s.begin(), s.end()));
+    EXPECT_LE(s.height(), 8);
+}
+
+
+TEST(AVLSet_ExtendedTests, joiningSetsOfVeryDifferentSizesStaysBalanced)
+{
+    std::vector<int> large;
+    std::vector<int> small{100000, 100001, 100002};
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        large.push_back(i);
+    }
+
+    AVLSet<int> s1{large.begin(), large.end()};
+    AVLSet<int> s2{small.begin(), small.end()};
+    AVLSet<int> s3{small.begin(), small.end()};
+    AVLSet<int> s4{large.begin(), large.end()};
+
+    s1.join(std::move(s2));
+    s3.join(std::move(s4));
+
+    for (const AVLSet<int>* s : {&s1, &s3})
+    {
+        EXPECT_EQ(100003, s->size());
+        EXPECT_TRUE(std::is_sorted(s->begin(), s->end()));
+        EXPECT_LE(s->height(), 17);
+    }
+
+    EXPECT_EQ(0, *s1.begin());
+    EXPECT_EQ(nullptr, s1.upperBound(100002));
+}
+
+
+TEST(AVLSet_ExtendedTests, joiningOverlappingSetsMergesThem)
+{
+    std::vector<int> v1{1, 3, 5, 7, 9};
+    std::vector<int> v2{2, 3, 4, 10};
+
+    AVLSet<int> s1{v1.begin(), v1.end()};
+    AVLSet<int> s2{v2.begin(), v2.end()};
+
+    s1.join(std::move(s2));
+
+    std::vector<int> expected{1, 2, 3, 4, 5, 7, 9, 10};
+    EXPECT_EQ(expected, std::vector<int>(s1.begin(), s1.end()));
+}
+
+
+TEST(AVLSet_ExtendedTests, unionKeepsOneOfEachElement)
+{
+    AVLSet<std::string> base;
+    AVLSet<std::string> domain;
+
+    for (int i = 0; i < 2000; ++i)
+    {
+        base.add("WORD" + std::to_string(i * 3));
+    }
+
+    for (int i = 0; i < 300; ++i)
+    {
+        domain.add("WORD" + std::to_string(i * 5));
+    }
+
+    base.unionWith(domain);
+
+    // 2000 multiples of 3, plus the 300 multiples of 5, less the 100 of
+    // those that are also multiples of 3.
+    EXPECT_EQ(2200, base.size());
+    EXPECT_TRUE(base.contains("WORD5"));
+    EXPECT_TRUE(base.contains("WORD3"));
+    EXPECT_TRUE(base.contains("WORD15"));
+    EXPECT_FALSE(base.contains("WORD7"));
+    EXPECT_TRUE(std::is_sorted(base.begin(), base.end()));
+    EXPECT_LE(base.height(), 15);
+}
+
+
+TEST(AVLSet_ExtendedTests, unbalancedSetsCanBeSplitAndMerged)
+{
+    AVLSet<int> s{false};
+
+    for (int i : {50, 20, 80, 10, 30, 70, 90})
+    {
+        s.add(i);
+    }
+
+    AVLSet<int> greater = s.split(60);
+
+    EXPECT_EQ((std::vector<int>{10, 20, 30, 50}), std::vector<int>(s.begin(), s.end()));
+    EXPECT_EQ((std::vector<int>{70, 80, 90}), std::vector<int>(greater.begin(), greater.end()));
+    EXPECT_EQ(2, s.height());
+    EXPECT_EQ(1, greater.height());
+
+    s.unionWith(greater);
+
+    EXPECT_EQ(7, s.size());
+    EXPECT_TRUE(std::is_sorted(s.begin(), s.end()));
+}
+
+
+TEST(AVLSet_ExtendedTests, buildingInParallelMatchesBuildingSequentially)
+{
+    std::vector<std::string> sorted;
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        sorted.push_back("WORD" + std::to_string(100000 + i));
+    }
+
+    std::vector<std::string> shuffled{sorted.rbegin(), sorted.rend()};
+    std::rotate(shuffled.begin(), shuffled.begin() + 7000, shuffled.end());
+
+    for (unsigned int threadCount : {1u, 3u, 8u})
+    {
+        AVLSet<std::string> s1 = AVLSet<std::string>::buildInParallel(sorted.begin(), sorted.end(), threadCount);
+        AVLSet<std::string> s2 = AVLSet<std::string>::buildInParallel(shuffled.begin(), shuffled.end(), threadCount);
+
+        EXPECT_EQ(sorted, std::vector<std::string>(s1.begin(), s1.end()));
+        EXPECT_EQ(sorted, std::vector<std::string>(s2.begin(), s2.end()));
+        EXPECT_LE(s1.height(), 16);
+        EXPECT_LE(s2.height(), 18);
+    }
+}
@@ -0,0 +1,55 @@
+// BatchLookup.hpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A BatchLookup is implemented by Sets that can search for many keys at
+// once more quickly than they can search for them one at a time.  Searches
+// in a large set are usually limited by waiting for memory; a set that
+// knows about several searches in advance can start loading the memory
+// that all of them need before it finishes any of them, so that the waits
+// overlap rather than adding up.
+//
+// A BatchLookup is an interface separate from Set, so that Sets that have
+// nothing to gain from it needn't implement it.  Code holding a reference
+// to a Set can discover it with a dynamic_cast, falling back to ordinary
+// searches when the Set isn't a BatchLookup.
+//
+// The keys of a batch have type BatchKey<ElementType>, which is
+// std::string_view for a set of std::string (so that the keys can be built
+// in one shared buffer, without a std::string apiece) and ElementType
+// otherwise.
+
+#ifndef BATCHLOOKUP_HPP
+#define BATCHLOOKUP_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+
+
+template <typename ElementType>
+using BatchKey = std::conditional_t<
+    std::is_same_v<ElementType, std::string>, std::string_view, ElementType>;
+
+
+
+template <typename KeyType>
+class BatchLookup
+{
+public:
+    virtual ~BatchLookup() noexcept = default;
+
+
+    // containsMany() searches for each of the "count" keys beginning at
+    // "keys," setting found[i] to true if keys[i] is in the set and false
+    // otherwise.  The results are the same as calling contains() for each
+    // key in turn.
+    virtual void containsMany(const KeyType* keys, std::size_t count, bool* found) const = 0;
+};
+
+
+
+#endif
@@ -0,0 +1,499 @@
+// ConcurrentHashSet.hpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A ConcurrentHashSet is an implementation of a Set that many threads can
+// use at once: any number of threads can call contains() while others call
+// add().  It is an open-addressed hash table like HashSet (see HashSet.hpp),
+// divided into a power-of-two number of independent "shards," with the top
+// bits of an element's hash choosing its shard.
+//
+// Each shard has a mutex that serializes the threads adding to it, so adds
+// to different shards proceed in parallel.  contains() never locks, never
+// waits, and never retries; it doesn't write to shared memory at all, so
+// searches on different cores don't slow one another down.  That works
+// because a shard's table is only ever changed in ways that a concurrent
+// search can safely observe:
+//
+// * Elements are stored separately (in a NodePool) and never move, and each
+//   slot holds a pointer to its element.  An element and its slot are filled
+//   in before the slot's control byte is published with a release store, and
+//   searches read control bytes with acquire loads, so a search that sees a
+//   full slot also sees its element.
+//
+// * Control bytes are read and written eight at a time, as one 64-bit atomic
+//   "group," and matched with bitwise arithmetic (rather than the SIMD
+//   compares that HashSet uses).
+//
+// * When a shard's table grows, a new table is filled in privately and then
+//   published.  The old table is left intact, since searches may still be
+//   reading it, and is retired until the ConcurrentHashSet is destroyed.
+//   Because tables double in size, the retired tables of a shard are never
+//   larger, in total, than its current one.
+//
+// Elements are never removed, so no table ever needs tombstones, and no
+// element or table is freed while a search might be using it.
+
+#ifndef CONCURRENTHASHSET_HPP
+#define CONCURRENTHASHSET_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <type_traits>
+#include "Hashing.hpp"
+#include "KeyLookup.hpp"
+#include "NodePool.hpp"
+#include "Set.hpp"
+
+
+
+template <typename ElementType, typename Hasher = FunctionHash<ElementType>>
+class ConcurrentHashSet : public Set<ElementType>
+{
+public:
+    // The number of shards used when none is specified.
+    static constexpr unsigned int DEFAULT_SHARD_COUNT = 16;
+
+    // The capacity of a shard's table the first time anything is added to
+    // the shard.
+    static constexpr unsigned int DEFAULT_SHARD_CAPACITY = 16;
+
+public:
+    // Initializes a ConcurrentHashSet to be empty, so that it will use the
+    // given hash policy whenever it needs to hash an element (see
+    // Hashing.hpp).  The shard count is rounded up to a power of two.
+    explicit ConcurrentHashSet(Hasher hasher = Hasher{}, unsigned int shardCount = DEFAULT_SHARD_COUNT);
+
+    // Cleans up the ConcurrentHashSet so that it leaks no memory.  No other
+    // thread may be using it.
+    ~ConcurrentHashSet() noexcept override;
+
+    // A ConcurrentHashSet is shared by threads in place, so it can be
+    // neither copied nor moved.
+    ConcurrentHashSet(const ConcurrentHashSet& s) = delete;
+    ConcurrentHashSet& operator=(const ConcurrentHashSet& s) = delete;
+
+
+    bool isImplemented() const noexcept override;
+
+
+    // add() adds an element to the set.  If the element is already in the
+    // set, this function has no effect.  Adds to the same shard are done one
+    // at a time; adds to different shards can be done simultaneously.
+    void add(const ElementType& element) override;
+
+
+    // contains() returns true if the given element is already in the set,
+    // false otherwise.  This function never blocks, even while other threads
+    // are adding to the set.  If an element is being added simultaneously,
+    // it may or may not be found.
+    bool contains(const ElementType& element) const override;
+
+
+    // contains() can also be given a key of another type that can be
+    // compared to the elements directly.  (See KeyLookup.hpp.)
+    template <typename KeyType, typename = impl_::Set__TransparentKey<ElementType, KeyType>>
+    bool contains(const KeyType& key) const;
+
+
+    // size() returns the number of elements in the set.  While elements are
+    // being added, the result may not include all of them.
+    unsigned int size() const noexcept override;
+
+
+    // shardCount() returns the number of shards.
+    unsigned int shardCount() const noexcept;
+
+
+private:
+    // A Table is a shard's array of control bytes, stored eight to a group,
+    // and its parallel array of pointers to elements.
+    struct Table
+    {
+        std::atomic<std::uint64_t>* control;
+        const ElementType** slots;
+        unsigned int capacity;
+
+        // The table that this one replaced, if any.
+        Table* previous;
+    };
+
+    // Each shard is aligned to its own cache lines, with the table that
+    // searches read kept away from the mutex and counts that adds write.
+    struct alignas(64) Shard
+    {
+        alignas(64) std::atomic<Table*> table;
+
+        alignas(64) std::mutex mutex;
+        std::atomic<unsigned int> count;
+        NodePool<ElementType> elements;
+    };
+
+    Hasher hasher;
+    std::unique_ptr<Shard[]> shards;
+    unsigned int shardBits;
+
+private:
+    std::uint64_t hashOf(const ElementType& element) const;
+    const Shard& shardFor(std::uint64_t hash) const noexcept;
+    Shard& shardFor(std::uint64_t hash) noexcept;
+
+    template <typename KeyType>
+    static bool find(const Table* t, const KeyType& key, std::uint64_t hash, unsigned int& slot) noexcept;
+
+    void grow(Shard& shard);
+
+    static Table* allocateTable(unsigned int capacity, Table* previous);
+    static void publish(Table* t, unsigned int slot, const ElementType* element, std::uint64_t hash) noexcept;
+};
+
+
+
+namespace impl_
+{
+    constexpr std::uint64_t ConcurrentHashSet__LOW_BITS = 0x0101010101010101ULL;
+    constexpr std::uint64_t ConcurrentHashSet__HIGH_BITS = 0x8080808080808080ULL;
+
+    // A group of eight control bytes in which every slot is empty.
+    constexpr std::uint64_t ConcurrentHashSet__EMPTY_GROUP = ConcurrentHashSet__HIGH_BITS;
+
+
+    // ConcurrentHashSet__matchTag() returns a mask with the high bit of each
+    // byte of the group set if that byte might be the given tag.  (The
+    // arithmetic can also flag a byte just above a matching one, so each
+    // candidate must be checked.)
+    inline std::uint64_t ConcurrentHashSet__matchTag(std::uint64_t group, std::uint64_t tag) noexcept
+    {
+        std::uint64_t x = group ^ (ConcurrentHashSet__LOW_BITS * tag);
+        return (x - ConcurrentHashSet__LOW_BITS) & ~x & ConcurrentHashSet__HIGH_BITS;
+    }
+
+
+    inline std::uint64_t ConcurrentHashSet__matchEmpty(std::uint64_t group) noexcept
+    {
+        return group & ConcurrentHashSet__HIGH_BITS;
+    }
+
+
+    // ConcurrentHashSet__lowestByte() returns the index of the lowest byte
+    // whose high bit is set in a non-zero mask.
+    inline unsigned int ConcurrentHashSet__lowestByte(std::uint64_t mask) noexcept
+    {
+#if defined(__GNUC__)
+        return static_cast<unsigned int>(__builtin_ctzll(mask)) / 8;
+#else
+        unsigned int byte = 0;
+
+        while ((mask & 0x80) == 0)
+        {
+            mask >>= 8;
+            ++byte;
+        }
+
+        return byte;
+#endif
+    }
+
+
+    inline unsigned int ConcurrentHashSet__roundUpToPowerOfTwo(unsigned int n) noexcept
+    {
+        unsigned int powerOfTwo = 1;
+
+        while (powerOfTwo < n)
+        {
+            powerOfTwo *= 2;
+        }
+
+        return powerOfTwo;
+    }
+}
+
+
+template <typename ElementType, typename Hasher>
+ConcurrentHashSet<ElementType, Hasher>::ConcurrentHashSet(Hasher hasher, unsigned int shardCount)
+    : hasher{std::move(hasher)}, shardBits{0}
+{
+    shardCount = impl_::ConcurrentHashSet__roundUpToPowerOfTwo(shardCount);
+
+    while ((1u << shardBits) < shardCount)
+    {
+        ++shardBits;
+    }
+
+    shards.reset(new Shard[shardCount]);
+
+    for (unsigned int i = 0; i < shardCount; ++i)
+    {
+        shards[i].table.store(nullptr, std::memory_order_relaxed);
+        shards[i].count.store(0, std::memory_order_relaxed);
+    }
+}
+
+
+template <typename ElementType, typename Hasher>
+ConcurrentHashSet<ElementType, Hasher>::~ConcurrentHashSet() noexcept
+{
+    for (unsigned int i = 0; i < shardCount(); ++i)
+    {
+        Table* t = shards[i].table.load(std::memory_order_relaxed);
+
+        while (t != nullptr)
+        {
+            Table* previous = t->previous;
+
+            delete[] t->control;
+            delete[] t->slots;
+            delete t;
+
+            t = previous;
+        }
+    }
+
+    // The elements themselves are destroyed by each shard's NodePool.
+}
+
+
+template <typename ElementType, typename Hasher>
+bool ConcurrentHashSet<ElementType, Hasher>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename ElementType, typename Hasher>
+void ConcurrentHashSet<ElementType, Hasher>::add(const ElementType& element)
+{
+    std::uint64_t hash = hashOf(element);
+    Shard& shard = shardFor(hash);
+
+    std::lock_guard<std::mutex> lock{shard.mutex};
+
+    // Only threads holding the mutex change the table, so it can't change
+    // out from under us from here on.
+    Table* t = shard.table.load(std::memory_order_relaxed);
+    unsigned int slot;
+
+    if (t != nullptr && find(t, element, hash, slot))
+    {
+        return;
+    }
+
+    unsigned int count = shard.count.load(std::memory_order_relaxed);
+
+    if (t == nullptr || count + 1 > t->capacity - t->capacity / 8)
+    {
+        grow(shard);
+        t = shard.table.load(std::memory_order_relaxed);
+        find(t, element, hash, slot);
+    }
+
+    const ElementType* stored = shard.elements.create(element);
+    publish(t, slot, stored, hash);
+
+    shard.count.store(count + 1, std::memory_order_relaxed);
+}
+
+
+template <typename ElementType, typename Hasher>
+bool ConcurrentHashSet<ElementType, Hasher>::contains(const ElementType& element) const
+{
+    std::uint64_t hash = hashOf(element);
+    const Table* t = shardFor(hash).table.load(std::memory_order_acquire);
+    unsigned int slot;
+
+    return t != nullptr && find(t, element, hash, slot);
+}
+
+
+template <typename ElementType, typename Hasher>
+template <typename KeyType, typename>
+bool ConcurrentHashSet<ElementType, Hasher>::contains(const KeyType& key) const
+{
+    std::string_view view{key};
+    std::uint64_t hash;
+
+    if constexpr (std::is_invocable_v<const Hasher&, std::string_view>)
+    {
+        hash = hasher(view);
+    }
+    else
+    {
+        // The hash policy only accepts an ElementType, so the key is copied
+        // into a per-thread buffer that's reused from one call to the next.
+        thread_local ElementType buffer;
+        buffer.assign(view.data(), view.size());
+        hash = hashOf(buffer);
+    }
+
+    const Table* t = shardFor(hash).table.load(std::memory_order_acquire);
+    unsigned int slot;
+
+    return t != nullptr && find(t, view, hash, slot);
+}
+
+
+template <typename ElementType, typename Hasher>
+unsigned int ConcurrentHashSet<ElementType, Hasher>::size() const noexcept
+{
+    unsigned int total = 0;
+
+    for (unsigned int i = 0; i < shardCount(); ++i)
+    {
+        total += shards[i].count.load(std::memory_order_relaxed);
+    }
+
+    return total;
+}
+
+
+template <typename ElementType, typename Hasher>
+unsigned int ConcurrentHashSet<ElementType, Hasher>::shardCount() const noexcept
+{
+    return 1u << shardBits;
+}
+
+
+template <typename ElementType, typename Hasher>
+std::uint64_t ConcurrentHashSet<ElementType, Hasher>::hashOf(const ElementType& element) const
+{
+    return hasher(element);
+}
+
+
+template <typename ElementType, typename Hasher>
+const typename ConcurrentHashSet<ElementType, Hasher>::Shard&
+ConcurrentHashSet<ElementType, Hasher>::shardFor(std::uint64_t hash) const noexcept
+{
+    return shards[shardBits == 0 ? 0 : static_cast<unsigned int>(hash >> (64 - shardBits))];
+}
+
+
+template <typename ElementType, typename Hasher>
+typename ConcurrentHashSet<ElementType, Hasher>::Shard&
+ConcurrentHashSet<ElementType, Hasher>::shardFor(std::uint64_t hash) noexcept
+{
+    return shards[shardBits == 0 ? 0 : static_cast<unsigned int>(hash >> (64 - shardBits))];
+}
+
+
+// find() searches the given table for the given key, whose hash has already
+// been determined.  If an element equal to it is found, its slot is stored
+// into "slot" and true is returned; otherwise, the empty slot where it
+// belongs is stored into "slot" and false is returned.  The search probes
+// the groups of the table in the same triangular sequence that HashSet uses.
+template <typename ElementType, typename Hasher>
+template <typename KeyType>
+bool ConcurrentHashSet<ElementType, Hasher>::find(
+    const Table* t, const KeyType& key, std::uint64_t hash, unsigned int& slot) noexcept
+{
+    const std::uint64_t tag = hash & 0x7F;
+    const unsigned int mask = t->capacity / 8 - 1;
+    unsigned int group = static_cast<unsigned int>(hash >> 7) & mask;
+
+    for (unsigned int step = 1; ; ++step)
+    {
+        std::uint64_t control = t->control[group].load(std::memory_order_acquire);
+
+        for (std::uint64_t matches = impl_::ConcurrentHashSet__matchTag(control, tag);
+             matches != 0; matches &= matches - 1)
+        {
+            unsigned int byte = impl_::ConcurrentHashSet__lowestByte(matches);
+
+            if (((control >> (byte * 8)) & 0xFF) == tag && *t->slots[group * 8 + byte] == key)
+            {
+                slot = group * 8 + byte;
+                return true;
+            }
+        }
+
+        std::uint64_t empty = impl_::ConcurrentHashSet__matchEmpty(control);
+
+        if (empty != 0)
+        {
+            slot = group * 8 + impl_::ConcurrentHashSet__lowestByte(empty);
+            return false;
+        }
+
+        group = (group + step) & mask;
+    }
+}
+
+
+// grow() replaces the given shard's table with one twice as large (or
+// creates its first table), publishing the new table only once every
+// element is in it.  The caller must hold the shard's mutex.
+template <typename ElementType, typename Hasher>
+void ConcurrentHashSet<ElementType, Hasher>::grow(Shard& shard)
+{
+    Table* oldTable = shard.table.load(std::memory_order_relaxed);
+    unsigned int newCapacity = oldTable == nullptr ? DEFAULT_SHARD_CAPACITY : oldTable->capacity * 2;
+    Table* newTable = allocateTable(newCapacity, oldTable);
+
+    if (oldTable != nullptr)
+    {
+        for (unsigned int i = 0; i < oldTable->capacity; ++i)
+        {
+            const ElementType* element = oldTable->slots[i];
+
+            if (element != nullptr)
+            {
+                std::uint64_t hash = hashOf(*element);
+                unsigned int slot;
+
+                find(newTable, *element, hash, slot);
+                publish(newTable, slot, element, hash);
+            }
+        }
+    }
+
+    shard.table.store(newTable, std::memory_order_release);
+}
+
+
+template <typename ElementType, typename Hasher>
+typename ConcurrentHashSet<ElementType, Hasher>::Table*
+ConcurrentHashSet<ElementType, Hasher>::allocateTable(unsigned int capacity, Table* previous)
+{
+    std::unique_ptr<std::atomic<std::uint64_t>[]> control{new std::atomic<std::uint64_t>[capacity / 8]};
+    std::unique_ptr<const ElementType*[]> slots{new const ElementType*[capacity]()};
+
+    for (unsigned int i = 0; i < capacity / 8; ++i)
+    {
+        control[i].store(impl_::ConcurrentHashSet__EMPTY_GROUP, std::memory_order_relaxed);
+    }
+
+    Table* t = new Table{control.get(), slots.get(), capacity, previous};
+
+    control.release();
+    slots.release();
+
+    return t;
+}
+
+
+// publish() stores the given element into the given empty slot, then makes
+// it visible to searches by filling in its control byte.  Only one thread
+// ever publishes into a table at a time.
+template <typename ElementType, typename Hasher>
+void ConcurrentHashSet<ElementType, Hasher>::publish(
+    Table* t, unsigned int slot, const ElementType* element, std::uint64_t hash) noexcept
+{
+    t->slots[slot] = element;
+
+    std::atomic<std::uint64_t>& group = t->control[slot / 8];
+    unsigned int shift = (slot % 8) * 8;
+
+    std::uint64_t control = group.load(std::memory_order_relaxed);
+    control &= ~(0xFFULL << shift);
+    control |= (hash & 0x7F) << shift;
+
+    group.store(control, std::memory_order_release);
+}
+
+
+
+#endif
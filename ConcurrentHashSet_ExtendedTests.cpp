@@ -0,0 +1,197 @@
+// ConcurrentHashSet_ExtendedTests.cpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// These unit tests check that a ConcurrentHashSet behaves like a Set when
+// used by one thread, and that elements added by some threads are found by
+// others while searches and adds are going on simultaneously.
+
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "ConcurrentHashSet.hpp"
+
+
+namespace
+{
+    template <typename T>
+    unsigned int zeroHash(const T&)
+    {
+        return 0;
+    }
+
+
+    unsigned int identityHash(const int& i)
+    {
+        return static_cast<unsigned int>(i);
+    }
+}
+
+
+TEST(ConcurrentHashSet_ExtendedTests, shardCountIsRoundedUpToAPowerOfTwo)
+{
+    ConcurrentHashSet<int> s1{identityHash, 1};
+    ConcurrentHashSet<int> s2{identityHash, 5};
+    ConcurrentHashSet<int> s3{identityHash};
+
+    ASSERT_EQ(1, s1.shardCount());
+    ASSERT_EQ(8, s2.shardCount());
+    ASSERT_EQ(ConcurrentHashSet<int>::DEFAULT_SHARD_COUNT, s3.shardCount());
+}
+
+
+TEST(ConcurrentHashSet_ExtendedTests, addingManyElementsGrowsEveryShard)
+{
+    ConcurrentHashSet<int> s{identityHash, 4};
+
+    for (int i = 0; i < 5000; ++i)
+    {
+        s.add(i);
+        s.add(i);
+    }
+
+    ASSERT_EQ(5000, s.size());
+
+    for (int i = 0; i < 5000; ++i)
+    {
+        ASSERT_TRUE(s.contains(i));
+    }
+
+    ASSERT_FALSE(s.contains(-1));
+    ASSERT_FALSE(s.contains(5000));
+}
+
+
+TEST(ConcurrentHashSet_ExtendedTests, elementsWithTheSameHashAreAllFound)
+{
+    ConcurrentHashSet<int> s{zeroHash<int>, 2};
+
+    for (int i = 0; i < 100; ++i)
+    {
+        s.add(i);
+    }
+
+    ASSERT_EQ(100, s.size());
+
+    for (int i = 0; i < 100; ++i)
+    {
+        ASSERT_TRUE(s.contains(i));
+    }
+
+    ASSERT_FALSE(s.contains(100));
+}
+
+
+TEST(ConcurrentHashSet_ExtendedTests, canLookUpStringsByStringView)
+{
+    ConcurrentHashSet<std::string, WyHash> s;
+    s.add("Boo");
+    s.add("is");
+
+    std::string_view text{"Boo is happy"};
+
+    ASSERT_TRUE(s.contains(text.substr(0, 3)));
+    ASSERT_TRUE(s.contains(text.substr(4, 2)));
+    ASSERT_FALSE(s.contains(text.substr(7)));
+}
+
+
+TEST(ConcurrentHashSet_ExtendedTests, threadsAddingDisjointElementsAddThemAll)
+{
+    constexpr int threadCount = 8;
+    constexpr int perThread = 4000;
+
+    ConcurrentHashSet<int, WyHash> s;
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back(
+            [&s, t]
+            {
+                for (int i = 0; i < perThread; ++i)
+                {
+                    s.add(t * perThread + i);
+                }
+            });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    ASSERT_EQ(threadCount * perThread, s.size());
+
+    for (int i = 0; i < threadCount * perThread; ++i)
+    {
+        ASSERT_TRUE(s.contains(i));
+    }
+}
+
+
+TEST(ConcurrentHashSet_ExtendedTests, searchesSeeExistingElementsWhileOthersAreAdded)
+{
+    constexpr int existing = 2000;
+    constexpr int added = 20000;
+    constexpr int readerCount = 4;
+
+    ConcurrentHashSet<int, WyHash> s{WyHash{}, 2};
+
+    for (int i = 0; i < existing; ++i)
+    {
+        s.add(i);
+    }
+
+    std::atomic<bool> done{false};
+    std::atomic<int> misses{0};
+    std::vector<std::thread> readers;
+
+    for (int r = 0; r < readerCount; ++r)
+    {
+        readers.emplace_back(
+            [&]
+            {
+                while (!done.load())
+                {
+                    for (int i = 0; i < existing; ++i)
+                    {
+                        if (!s.contains(i))
+                        {
+                            ++misses;
+                        }
+                    }
+
+                    if (s.contains(-1))
+                    {
+                        ++misses;
+                    }
+                }
+            });
+    }
+
+    std::thread writer{
+        [&]
+        {
+            for (int i = existing; i < existing + added; ++i)
+            {
+                s.add(i);
+            }
+
+            done.store(true);
+        }};
+
+    writer.join();
+
+    for (std::thread& reader : readers)
+    {
+        reader.join();
+    }
+
+    ASSERT_EQ(0, misses.load());
+    ASSERT_EQ(existing + added, s.size());
+}
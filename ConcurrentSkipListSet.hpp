@@ -0,0 +1,443 @@
+// ConcurrentSkipListSet.hpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A ConcurrentSkipListSet is an implementation of a Set that is a skip list
+// (like SkipListSet; see SkipListSet.hpp) that many threads can use at once,
+// keeping its elements in order, with no locks at all.  Any number of
+// threads can call add() and contains() simultaneously.
+//
+// As in a SkipListSet, each element is stored once, in a node followed by
+// its tower of forward pointers, but the pointers are atomic:
+//
+// * add() links a new node into each level with a compare-and-swap on its
+//   predecessor's pointer, starting with level 0, which is the moment the
+//   element becomes part of the set.  If another thread changed that
+//   pointer first, add() searches for the predecessors again and retries;
+//   some thread's compare-and-swap always succeeds, so the set as a whole
+//   always makes progress.  Two threads adding the same element race to
+//   link it into level 0, and the loser discards its node.
+//
+// * A node's forward pointer on each level is set before the node is
+//   published on that level with a release compare-and-swap, and searches
+//   follow pointers with acquire loads, so a search that reaches a node on
+//   some level sees its element and its pointers on that level and below.
+//   contains() never writes to shared memory and never retries, so it
+//   finishes in a bounded number of steps no matter what other threads do.
+//
+// * Elements are never removed, so a node, once linked, is never unlinked
+//   or freed while a search might be using it; the nodes are destroyed with
+//   the ConcurrentSkipListSet.
+//
+// The "coin flips" that choose a new node's height come from a generator
+// belonging to the calling thread, so threads needn't share one (as they
+// would a SkipListLevelTester).
+
+#ifndef CONCURRENTSKIPLISTSET_HPP
+#define CONCURRENTSKIPLISTSET_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <random>
+#include <string_view>
+#include "KeyLookup.hpp"
+#include "Set.hpp"
+
+
+
+template <typename ElementType>
+class ConcurrentSkipListSet : public Set<ElementType>
+{
+public:
+    // The most levels that a ConcurrentSkipListSet will have.
+    static constexpr unsigned int MAX_LEVEL_COUNT = 32;
+
+public:
+    // Initializes a ConcurrentSkipListSet to be empty.
+    ConcurrentSkipListSet();
+
+    // Cleans up the ConcurrentSkipListSet so that it leaks no memory.  No
+    // other thread may be using it.
+    ~ConcurrentSkipListSet() noexcept override;
+
+    // A ConcurrentSkipListSet is shared by threads in place, so it can be
+    // neither copied nor moved.
+    ConcurrentSkipListSet(const ConcurrentSkipListSet& s) = delete;
+    ConcurrentSkipListSet& operator=(const ConcurrentSkipListSet& s) = delete;
+
+
+    bool isImplemented() const noexcept override;
+
+
+    // add() adds an element to the set.  If the element is already in the
+    // set, this function has no effect.  It runs in an expected time of
+    // O(log n), plus the time spent retrying when other threads change the
+    // same part of the list at the same moment.
+    void add(const ElementType& element) override;
+
+
+    // contains() returns true if the given element is already in the set,
+    // false otherwise.  This function never blocks or retries, even while
+    // other threads are adding to the set.  If an element is being added
+    // simultaneously, it may or may not be found.
+    bool contains(const ElementType& element) const override;
+
+
+    // contains() can also be given a key of another type that can be
+    // compared to the elements directly.  (See KeyLookup.hpp.)
+    template <typename KeyType, typename = impl_::Set__TransparentKey<ElementType, KeyType>>
+    bool contains(const KeyType& key) const;
+
+
+    // size() returns the number of elements in the set.  While elements are
+    // being added, the result may not include all of them.
+    unsigned int size() const noexcept override;
+
+
+    // levelCount() returns the number of levels in the skip list.
+    unsigned int levelCount() const noexcept;
+
+
+private:
+    // A Node is allocated with room for "height" atomic pointers after it,
+    // which forward() returns; forward()[i] is the following node on level i.
+    struct Node
+    {
+        ElementType key;
+        unsigned int height;
+
+        std::atomic<Node*>* forward() noexcept;
+        const std::atomic<Node*>* forward() const noexcept;
+    };
+
+    static constexpr std::size_t TOWER_OFFSET =
+        (sizeof(Node) + alignof(std::atomic<Node*>) - 1)
+        / alignof(std::atomic<Node*>) * alignof(std::atomic<Node*>);
+
+    // head[i] is the first node on level i, or nullptr if it's empty.
+    std::atomic<Node*> head[MAX_LEVEL_COUNT];
+    std::atomic<unsigned int> levels;
+    std::atomic<unsigned int> count;
+
+private:
+    bool findPosition(
+        const ElementType& element, std::atomic<Node*>** predecessors, Node** successors);
+
+    template <typename KeyType>
+    bool find(const KeyType& key) const;
+
+    unsigned int chooseHeight() noexcept;
+
+    static Node* createNode(const ElementType& element, unsigned int height);
+    static void destroyNode(Node* node) noexcept;
+};
+
+
+
+namespace impl_
+{
+    // ConcurrentSkipListSet__randomBits() returns 64 random bits from a
+    // generator belonging to the calling thread, seeded when the thread
+    // first calls it.  (This is the "SplitMix64" generator, which is tiny,
+    // fast, and plenty random enough for coin flips.)
+    inline std::uint64_t ConcurrentSkipListSet__randomBits() noexcept
+    {
+        thread_local std::uint64_t state =
+            (static_cast<std::uint64_t>(std::random_device{}()) << 32) ^ std::random_device{}();
+
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+
+    // ConcurrentSkipListSet__trailingZeros() returns the number of
+    // consecutive zero bits at the bottom of a non-zero value.
+    inline unsigned int ConcurrentSkipListSet__trailingZeros(std::uint64_t value) noexcept
+    {
+#if defined(__GNUC__)
+        return static_cast<unsigned int>(__builtin_ctzll(value));
+#else
+        unsigned int zeros = 0;
+
+        while ((value & 1) == 0)
+        {
+            value >>= 1;
+            ++zeros;
+        }
+
+        return zeros;
+#endif
+    }
+}
+
+
+
+template <typename ElementType>
+ConcurrentSkipListSet<ElementType>::ConcurrentSkipListSet()
+    : levels{1}, count{0}
+{
+    for (std::atomic<Node*>& first : head)
+    {
+        first.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+
+template <typename ElementType>
+ConcurrentSkipListSet<ElementType>::~ConcurrentSkipListSet() noexcept
+{
+    Node* node = head[0].load(std::memory_order_acquire);
+
+    while (node != nullptr)
+    {
+        Node* next = node->forward()[0].load(std::memory_order_relaxed);
+        destroyNode(node);
+        node = next;
+    }
+}
+
+
+template <typename ElementType>
+bool ConcurrentSkipListSet<ElementType>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename ElementType>
+void ConcurrentSkipListSet<ElementType>::add(const ElementType& element)
+{
+    std::atomic<Node*>* predecessors[MAX_LEVEL_COUNT];
+    Node* successors[MAX_LEVEL_COUNT];
+
+    if (findPosition(element, predecessors, successors))
+    {
+        return;
+    }
+
+    unsigned int height = chooseHeight();
+    Node* node = createNode(element, height);
+
+    // Linking the node into level 0 adds the element; if another thread
+    // got there first, the search is repeated, which either finds that the
+    // element was added in the meantime or finds where it goes now.
+    node->forward()[0].store(successors[0], std::memory_order_relaxed);
+
+    while (!predecessors[0]->compare_exchange_weak(
+        successors[0], node, std::memory_order_release, std::memory_order_relaxed))
+    {
+        bool found;
+
+        // Until it's linked, the node belongs to no one else, so it's
+        // destroyed here if comparing the elements throws.
+        try
+        {
+            found = findPosition(element, predecessors, successors);
+        }
+        catch (...)
+        {
+            destroyNode(node);
+            throw;
+        }
+
+        if (found)
+        {
+            destroyNode(node);
+            return;
+        }
+
+        node->forward()[0].store(successors[0], std::memory_order_relaxed);
+    }
+
+    count.fetch_add(1, std::memory_order_relaxed);
+
+    // The upper levels are linked from the bottom up.  They only make the
+    // node faster to find, so a search that misses them is still correct.
+    for (unsigned int i = 1; i < height; ++i)
+    {
+        for (;;)
+        {
+            node->forward()[i].store(successors[i], std::memory_order_relaxed);
+
+            if (predecessors[i]->compare_exchange_weak(
+                    successors[i], node, std::memory_order_release, std::memory_order_relaxed))
+            {
+                break;
+            }
+
+            findPosition(element, predecessors, successors);
+        }
+    }
+}
+
+
+// findPosition() searches for the given element, storing into
+// predecessors[i] the pointer on level i that points to the first node
+// whose element isn't less than it (the head of the level, or part of the
+// tower of the node before it), and into successors[i] that node, or
+// nullptr if there is none, for every level.  It returns true if the
+// element is already in the set.  It throws whatever comparing the
+// elements throws.
+template <typename ElementType>
+bool ConcurrentSkipListSet<ElementType>::findPosition(
+    const ElementType& element, std::atomic<Node*>** predecessors, Node** successors)
+{
+    std::atomic<Node*>* forward = head;
+
+    for (unsigned int i = MAX_LEVEL_COUNT; i-- > 0; )
+    {
+        Node* next = forward[i].load(std::memory_order_acquire);
+
+        while (next != nullptr && next->key < element)
+        {
+            forward = next->forward();
+            next = forward[i].load(std::memory_order_acquire);
+        }
+
+        predecessors[i] = &forward[i];
+        successors[i] = next;
+    }
+
+    return successors[0] != nullptr && !(element < successors[0]->key);
+}
+
+
+template <typename ElementType>
+bool ConcurrentSkipListSet<ElementType>::contains(const ElementType& element) const
+{
+    return find(element);
+}
+
+
+template <typename ElementType>
+template <typename KeyType, typename>
+bool ConcurrentSkipListSet<ElementType>::contains(const KeyType& key) const
+{
+    return find(std::string_view{key});
+}
+
+
+// find() searches from the top level in use, as a SkipListSet does.  A
+// level added after the search starts is simply not used by it.
+template <typename ElementType>
+template <typename KeyType>
+bool ConcurrentSkipListSet<ElementType>::find(const KeyType& key) const
+{
+    const std::atomic<Node*>* forward = head;
+    const Node* stop = nullptr;
+
+    for (unsigned int i = levels.load(std::memory_order_acquire); i-- > 0; )
+    {
+        const Node* next = forward[i].load(std::memory_order_acquire);
+
+        while (next != stop && next != nullptr && next->key < key)
+        {
+            forward = next->forward();
+            next = forward[i].load(std::memory_order_acquire);
+        }
+
+        stop = next;
+    }
+
+    return stop != nullptr && stop->key == key;
+}
+
+
+template <typename ElementType>
+unsigned int ConcurrentSkipListSet<ElementType>::size() const noexcept
+{
+    return count.load(std::memory_order_relaxed);
+}
+
+
+template <typename ElementType>
+unsigned int ConcurrentSkipListSet<ElementType>::levelCount() const noexcept
+{
+    return levels.load(std::memory_order_acquire);
+}
+
+
+// chooseHeight() flips coins for a new node's height -- one per random bit,
+// counting the heads before the first tails -- capped at one level above
+// the current top level, which it raises if necessary.
+template <typename ElementType>
+unsigned int ConcurrentSkipListSet<ElementType>::chooseHeight() noexcept
+{
+    std::uint64_t bits = impl_::ConcurrentSkipListSet__randomBits() | (std::uint64_t{1} << (MAX_LEVEL_COUNT - 1));
+    unsigned int height = impl_::ConcurrentSkipListSet__trailingZeros(bits) + 1;
+    unsigned int top = levels.load(std::memory_order_relaxed);
+
+    if (height > top)
+    {
+        height = top + 1 < MAX_LEVEL_COUNT ? top + 1 : MAX_LEVEL_COUNT;
+
+        while (top < height && !levels.compare_exchange_weak(top, height, std::memory_order_release))
+        {
+        }
+    }
+
+    return height;
+}
+
+
+// createNode() allocates a node with room for a tower of the given height,
+// with all of its pointers null.
+template <typename ElementType>
+typename ConcurrentSkipListSet<ElementType>::Node* ConcurrentSkipListSet<ElementType>::createNode(
+    const ElementType& element, unsigned int height)
+{
+    void* memory = ::operator new(TOWER_OFFSET + height * sizeof(std::atomic<Node*>));
+    Node* node;
+
+    try
+    {
+        node = new (memory) Node{element, height};
+    }
+    catch (...)
+    {
+        ::operator delete(memory);
+        throw;
+    }
+
+    std::atomic<Node*>* tower = node->forward();
+
+    for (unsigned int i = 0; i < height; ++i)
+    {
+        new (&tower[i]) std::atomic<Node*>{nullptr};
+    }
+
+    return node;
+}
+
+
+template <typename ElementType>
+void ConcurrentSkipListSet<ElementType>::destroyNode(Node* node) noexcept
+{
+    node->~Node();
+    ::operator delete(node);
+}
+
+
+template <typename ElementType>
+std::atomic<typename ConcurrentSkipListSet<ElementType>::Node*>*
+ConcurrentSkipListSet<ElementType>::Node::forward() noexcept
+{
+    return reinterpret_cast<std::atomic<Node*>*>(reinterpret_cast<char*>(this) + TOWER_OFFSET);
+}
+
+
+template <typename ElementType>
+const std::atomic<typename ConcurrentSkipListSet<ElementType>::Node*>*
+ConcurrentSkipListSet<ElementType>::Node::forward() const noexcept
+{
+    return reinterpret_cast<const std::atomic<Node*>*>(reinterpret_cast<const char*>(this) + TOWER_OFFSET);
+}
+
+
+
+#endif
@@ -0,0 +1,212 @@
+// ConcurrentSkipListSet_ExtendedTests.cpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// These unit tests check that a ConcurrentSkipListSet behaves like a Set
+// when used by one thread, that threads adding the same elements at once
+// add each of them exactly once, and that searches see existing elements
+// while others are being added, and that exceptions thrown by comparing
+// elements pass through add().
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "ConcurrentSkipListSet.hpp"
+
+
+namespace
+{
+    // A Fussy is an int whose comparisons throw while Fussy::throwing is
+    // true.
+    struct Fussy
+    {
+        int value;
+        inline static bool throwing = false;
+    };
+
+
+    bool operator<(const Fussy& a, const Fussy& b)
+    {
+        if (Fussy::throwing)
+        {
+            throw std::runtime_error{"comparison failed"};
+        }
+
+        return a.value < b.value;
+    }
+
+
+    bool operator==(const Fussy& a, const Fussy& b)
+    {
+        return a.value == b.value;
+    }
+}
+
+
+TEST(ConcurrentSkipListSet_ExtendedTests, containsElementsAddedByOneThread)
+{
+    ConcurrentSkipListSet<int> s;
+
+    for (int i = 5000; i > 0; --i)
+    {
+        s.add(i * 2);
+        s.add(i * 2);
+    }
+
+    ASSERT_EQ(5000, s.size());
+
+    for (int i = 1; i <= 5000; ++i)
+    {
+        ASSERT_TRUE(s.contains(i * 2));
+        ASSERT_FALSE(s.contains(i * 2 + 1));
+    }
+
+    ASSERT_FALSE(s.contains(0));
+    EXPECT_GT(s.levelCount(), 4);
+    EXPECT_LE(s.levelCount(), ConcurrentSkipListSet<int>::MAX_LEVEL_COUNT);
+}
+
+
+TEST(ConcurrentSkipListSet_ExtendedTests, canLookUpStringsByStringView)
+{
+    ConcurrentSkipListSet<std::string> s;
+    s.add("Boo");
+    s.add("is");
+
+    std::string_view text{"Boo is happy"};
+
+    ASSERT_TRUE(s.contains(text.substr(0, 3)));
+    ASSERT_TRUE(s.contains(text.substr(4, 2)));
+    ASSERT_FALSE(s.contains(text.substr(7)));
+}
+
+
+TEST(ConcurrentSkipListSet_ExtendedTests, threadsAddingTheSameElementsAddEachOnce)
+{
+    constexpr int threadCount = 8;
+    constexpr int elementCount = 5000;
+
+    ConcurrentSkipListSet<int> s;
+    std::vector<std::thread> threads;
+
+    for (int t = 0; t < threadCount; ++t)
+    {
+        threads.emplace_back(
+            [&s, t]
+            {
+                // Each thread adds the elements in a different order, so
+                // that they collide all over the list.
+                for (int i = 0; i < elementCount; ++i)
+                {
+                    s.add((i * (2 * t + 1)) % elementCount);
+                }
+            });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    ASSERT_EQ(elementCount, s.size());
+
+    for (int i = 0; i < elementCount; ++i)
+    {
+        ASSERT_TRUE(s.contains(i));
+    }
+
+    ASSERT_FALSE(s.contains(elementCount));
+}
+
+
+TEST(ConcurrentSkipListSet_ExtendedTests, searchesSeeExistingElementsWhileOthersAreAdded)
+{
+    constexpr int existing = 2000;
+    constexpr int added = 20000;
+    constexpr int readerCount = 4;
+
+    ConcurrentSkipListSet<int> s;
+
+    for (int i = 0; i < existing; ++i)
+    {
+        s.add(i * 2);
+    }
+
+    std::atomic<bool> done{false};
+    std::atomic<int> misses{0};
+    std::vector<std::thread> readers;
+
+    for (int r = 0; r < readerCount; ++r)
+    {
+        readers.emplace_back(
+            [&]
+            {
+                while (!done.load())
+                {
+                    for (int i = 0; i < existing; ++i)
+                    {
+                        if (!s.contains(i * 2))
+                        {
+                            ++misses;
+                        }
+                    }
+
+                    if (s.contains(-1))
+                    {
+                        ++misses;
+                    }
+                }
+            });
+    }
+
+    // The writers add odd elements in among the existing even ones.
+    std::vector<std::thread> writers;
+
+    for (int w = 0; w < 2; ++w)
+    {
+        writers.emplace_back(
+            [&s, w]
+            {
+                for (int i = w; i < added; i += 2)
+                {
+                    s.add(i * 2 + 1);
+                }
+            });
+    }
+
+    for (std::thread& writer : writers)
+    {
+        writer.join();
+    }
+
+    done.store(true);
+
+    for (std::thread& reader : readers)
+    {
+        reader.join();
+    }
+
+    ASSERT_EQ(0, misses.load());
+    ASSERT_EQ(existing + added, s.size());
+}
+
+
+TEST(ConcurrentSkipListSet_ExtendedTests, exceptionsFromComparisonsPassThroughAdd)
+{
+    ConcurrentSkipListSet<Fussy> s;
+    s.add(Fussy{1});
+
+    Fussy::throwing = true;
+    EXPECT_THROW(s.add(Fussy{2}), std::runtime_error);
+    Fussy::throwing = false;
+
+    EXPECT_EQ(1, s.size());
+    s.add(Fussy{2});
+    EXPECT_EQ(2, s.size());
+    EXPECT_TRUE(s.contains(Fussy{1}));
+}
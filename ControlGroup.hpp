@@ -0,0 +1,159 @@
+// ControlGroup.hpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A ControlGroup is a read-only view of WIDTH consecutive "control bytes"
+// in an open-addressed table.  Each control byte describes one slot of the
+// table: it is either EMPTY (which has its high bit set) or, when the slot
+// is full, a seven-bit "tag" taken from the hash of the element stored
+// there.  Looking at a whole group at once lets a lookup find every slot
+// whose tag matches (and every empty slot) with a handful of instructions,
+// so only slots that are very likely to hold the element are ever compared
+// against it.
+//
+// When SSE2 is available, a group is compared with a single 16-byte vector
+// compare; otherwise, a portable loop computes the same bit masks.
+
+#ifndef CONTROLGROUP_HPP
+#define CONTROLGROUP_HPP
+
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+
+class ControlGroup
+{
+public:
+    // The number of control bytes examined at once.
+    static constexpr unsigned int WIDTH = 16;
+
+    // The control byte that marks an empty slot.
+    static constexpr std::int8_t EMPTY = -128;
+
+    // A BitMask has bit i set when the i-th control byte of the group
+    // satisfied the query that produced it.
+    using BitMask = std::uint32_t;
+
+public:
+    // Initializes a ControlGroup to view the WIDTH control bytes starting
+    // at the given address.  The bytes need not be aligned.
+    explicit ControlGroup(const std::int8_t* bytes) noexcept;
+
+    // match() returns a mask of the full slots whose tag is the given one.
+    BitMask match(std::int8_t tag) const noexcept;
+
+    // matchEmpty() returns a mask of the empty slots.
+    BitMask matchEmpty() const noexcept;
+
+    // lowestBit() returns the position of the lowest set bit in a
+    // non-zero mask.
+    static unsigned int lowestBit(BitMask mask) noexcept;
+
+    // prefetch() asks the processor to start loading the WIDTH control
+    // bytes at the given address into the cache, without waiting for them.
+    // It's only a hint, and has no effect where prefetching isn't available.
+    static void prefetch(const std::int8_t* bytes) noexcept;
+
+    // emptyGroup() returns a group's worth of EMPTY control bytes, which a
+    // table with no slots can probe without any special cases.  It must
+    // never be written.
+    static const std::int8_t* emptyGroup() noexcept;
+
+private:
+    const std::int8_t* bytes;
+};
+
+
+
+inline ControlGroup::ControlGroup(const std::int8_t* bytes) noexcept
+    : bytes{bytes}
+{
+}
+
+
+inline ControlGroup::BitMask ControlGroup::match(std::int8_t tag) const noexcept
+{
+#if defined(__SSE2__)
+    __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+    return static_cast<BitMask>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(tag), group)));
+#else
+    BitMask mask = 0;
+
+    for (unsigned int i = 0; i < WIDTH; ++i)
+    {
+        mask |= static_cast<BitMask>(bytes[i] == tag) << i;
+    }
+
+    return mask;
+#endif
+}
+
+
+inline ControlGroup::BitMask ControlGroup::matchEmpty() const noexcept
+{
+    // EMPTY is the only control byte with its high bit set, so the
+    // sign bits of the group are exactly the empty slots.
+#if defined(__SSE2__)
+    __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+    return static_cast<BitMask>(_mm_movemask_epi8(group));
+#else
+    BitMask mask = 0;
+
+    for (unsigned int i = 0; i < WIDTH; ++i)
+    {
+        mask |= static_cast<BitMask>(bytes[i] < 0) << i;
+    }
+
+    return mask;
+#endif
+}
+
+
+inline unsigned int ControlGroup::lowestBit(BitMask mask) noexcept
+{
+#if defined(__GNUC__)
+    return static_cast<unsigned int>(__builtin_ctz(mask));
+#else
+    unsigned int position = 0;
+
+    while ((mask & 1) == 0)
+    {
+        mask >>= 1;
+        ++position;
+    }
+
+    return position;
+#endif
+}
+
+
+inline void ControlGroup::prefetch(const std::int8_t* bytes) noexcept
+{
+#if defined(__GNUC__)
+    __builtin_prefetch(bytes);
+#elif defined(__SSE2__)
+    _mm_prefetch(reinterpret_cast<const char*>(bytes), _MM_HINT_T0);
+#else
+    static_cast<void>(bytes);
+#endif
+}
+
+
+inline const std::int8_t* ControlGroup::emptyGroup() noexcept
+{
+    alignas(16) static const std::int8_t group[WIDTH] = {
+        EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY,
+        EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY, EMPTY
+    };
+
+    return group;
+}
+
+
+
+#endif
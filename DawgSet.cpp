@@ -0,0 +1,473 @@
+// DawgSet.cpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// Implementation of the DawgSet class.
+
+#include "DawgSet.hpp"
+#include <algorithm>
+#include "Hashing.hpp"
+
+
+
+DawgSet::DawgSet()
+{
+    clear();
+}
+
+
+bool DawgSet::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+void DawgSet::add(const std::string& word)
+{
+    if (containsKey(word))
+    {
+        return;
+    }
+
+    if (count == 0 || lastWord < word)
+    {
+        append(word);
+        return;
+    }
+
+    // The word belongs somewhere before the last one, where the frozen
+    // nodes can't be changed, so the DAWG is rebuilt with it.
+    std::vector<std::string> words;
+    words.reserve(count + 1);
+
+    std::string prefix;
+    visitWords(
+        StateRef{true, 0}, prefix,
+        [&words](const std::string& w)
+        {
+            words.push_back(w);
+        });
+
+    words.push_back(word);
+    build(std::move(words));
+}
+
+
+bool DawgSet::contains(const std::string& word) const
+{
+    return containsKey(word);
+}
+
+
+unsigned int DawgSet::size() const noexcept
+{
+    return count;
+}
+
+
+std::vector<std::string> DawgSet::findSuggestions(const std::string& word) const
+{
+    std::vector<std::string> suggestions;
+    std::string prefix;
+
+    suggestFrom(StateRef{true, 0}, word, 0, true, prefix, suggestions);
+
+    // The same word can be reached by more than one edit (e.g., inserting
+    // either of two equal characters), so there may be duplicates.
+    std::sort(suggestions.begin(), suggestions.end());
+    suggestions.erase(std::unique(suggestions.begin(), suggestions.end()), suggestions.end());
+
+    return suggestions;
+}
+
+
+std::vector<std::string> DawgSet::findWithinDistance(std::string_view word, unsigned int maxDistance) const
+{
+    std::size_t width = word.size() + 1;
+
+    // rows holds one row of the table for each character of the prefix
+    // being walked, plus the first row, for the empty prefix.
+    std::vector<unsigned int> rows(width);
+
+    for (std::size_t j = 0; j < width; ++j)
+    {
+        rows[j] = static_cast<unsigned int>(j);
+    }
+
+    std::vector<std::string> suggestions;
+    std::string prefix;
+
+    if (word.size() <= maxDistance && isFinal(StateRef{true, 0}))
+    {
+        suggestions.push_back(prefix);
+    }
+
+    walkWithinDistance(StateRef{true, 0}, word, maxDistance, prefix, rows, suggestions);
+
+    return suggestions;
+}
+
+
+std::size_t DawgSet::stateCount() const noexcept
+{
+    return states.size() + openPath.size();
+}
+
+
+void DawgSet::build(std::vector<std::string> words)
+{
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+
+    clear();
+
+    for (const std::string& word : words)
+    {
+        append(word);
+    }
+}
+
+
+void DawgSet::clear()
+{
+    states.clear();
+    edges.clear();
+    registry.clear();
+    openPath.assign(1, OpenState{false, {}});
+    lastWord.clear();
+    count = 0;
+}
+
+
+// append() adds a word that's larger than every word in the set.  The
+// open nodes beyond the prefix it shares with the last word will never
+// gain another edge, so they're frozen, deepest first (since a node can
+// only be compared to others once its children are frozen).
+void DawgSet::append(std::string_view word)
+{
+    std::size_t common = 0;
+
+    while (common < word.size() && common < lastWord.size() && word[common] == lastWord[common])
+    {
+        ++common;
+    }
+
+    for (std::size_t d = lastWord.size(); d > common; --d)
+    {
+        openPath[d - 1].edges.back().target = freeze(openPath[d]);
+    }
+
+    openPath.resize(common + 1);
+
+    for (std::size_t d = common; d < word.size(); ++d)
+    {
+        openPath[d].edges.push_back(Edge{OPEN, static_cast<unsigned char>(word[d])});
+        openPath.push_back(OpenState{false, {}});
+    }
+
+    openPath.back().final = true;
+    lastWord.assign(word);
+    ++count;
+}
+
+
+// freeze() returns the index of a frozen node equivalent to the given open
+// one -- with the same finality and the same edges -- adding one if there
+// is none.
+std::uint32_t DawgSet::freeze(const OpenState& state)
+{
+    if ((states.size() + 1) * 2 > registry.size())
+    {
+        growRegistry();
+    }
+
+    std::size_t mask = registry.size() - 1;
+    std::size_t edgeCount = state.edges.size();
+
+    for (std::size_t slot = hashOf(state.final, state.edges.data(), edgeCount) & mask; ; slot = (slot + 1) & mask)
+    {
+        std::uint32_t index = registry[slot];
+
+        if (index == EMPTY)
+        {
+            index = static_cast<std::uint32_t>(states.size());
+            states.push_back(FrozenState{
+                static_cast<std::uint32_t>(edges.size()), static_cast<std::uint16_t>(edgeCount), state.final});
+            edges.insert(edges.end(), state.edges.begin(), state.edges.end());
+            registry[slot] = index;
+            return index;
+        }
+
+        const FrozenState& frozen = states[index];
+
+        if (frozen.final == state.final && frozen.edgeCount == edgeCount
+            && std::equal(
+                state.edges.begin(), state.edges.end(), edges.begin() + frozen.firstEdge,
+                [](const Edge& a, const Edge& b)
+                {
+                    return a.label == b.label && a.target == b.target;
+                }))
+        {
+            return index;
+        }
+    }
+}
+
+
+void DawgSet::growRegistry()
+{
+    registry.assign(std::max<std::size_t>(registry.size() * 2, 16), EMPTY);
+    std::size_t mask = registry.size() - 1;
+
+    for (std::uint32_t index = 0; index < states.size(); ++index)
+    {
+        const FrozenState& frozen = states[index];
+        std::size_t slot = hashOf(frozen.final, edges.data() + frozen.firstEdge, frozen.edgeCount) & mask;
+
+        while (registry[slot] != EMPTY)
+        {
+            slot = (slot + 1) & mask;
+        }
+
+        registry[slot] = index;
+    }
+}
+
+
+std::uint64_t DawgSet::hashOf(bool final, const Edge* edges, std::size_t edgeCount) noexcept
+{
+    std::uint64_t hash = final ? 1 : 2;
+
+    for (std::size_t i = 0; i < edgeCount; ++i)
+    {
+        hash = impl_::Hashing__mix(hash ^ ((static_cast<std::uint64_t>(edges[i].target) << 8) | edges[i].label));
+    }
+
+    return hash;
+}
+
+
+bool DawgSet::containsKey(std::string_view key) const
+{
+    StateRef state{true, 0};
+
+    for (char c : key)
+    {
+        if (!follow(state, static_cast<unsigned char>(c)))
+        {
+            return false;
+        }
+    }
+
+    return isFinal(state);
+}
+
+
+bool DawgSet::isFinal(StateRef state) const noexcept
+{
+    return state.open ? openPath[state.index].final : states[state.index].final;
+}
+
+
+std::pair<const DawgSet::Edge*, std::size_t> DawgSet::edgesOf(StateRef state) const noexcept
+{
+    if (state.open)
+    {
+        const std::vector<Edge>& openEdges = openPath[state.index].edges;
+        return {openEdges.data(), openEdges.size()};
+    }
+    else
+    {
+        const FrozenState& frozen = states[state.index];
+        return {edges.data() + frozen.firstEdge, frozen.edgeCount};
+    }
+}
+
+
+// follow() moves the given state along its edge with the given label,
+// returning false (and leaving it unchanged) if there is no such edge.
+bool DawgSet::follow(StateRef& state, unsigned char label) const noexcept
+{
+    auto [first, edgeCount] = edgesOf(state);
+    const Edge* last = first + edgeCount;
+
+    const Edge* edge = std::lower_bound(
+        first, last, label,
+        [](const Edge& e, unsigned char l)
+        {
+            return e.label < l;
+        });
+
+    if (edge == last || edge->label != label)
+    {
+        return false;
+    }
+
+    state = targetOf(state, *edge);
+    return true;
+}
+
+
+DawgSet::StateRef DawgSet::targetOf(StateRef from, const Edge& edge) const noexcept
+{
+    if (edge.target == OPEN)
+    {
+        return StateRef{true, from.index + 1};
+    }
+    else
+    {
+        return StateRef{false, edge.target};
+    }
+}
+
+
+// visitWords() calls visit for each word reachable from the given state,
+// in ascending order, with prefix being the characters that reached it.
+template <typename Visit>
+void DawgSet::visitWords(StateRef state, std::string& prefix, Visit&& visit) const
+{
+    if (isFinal(state))
+    {
+        visit(prefix);
+    }
+
+    auto [first, edgeCount] = edgesOf(state);
+
+    for (std::size_t i = 0; i < edgeCount; ++i)
+    {
+        prefix.push_back(static_cast<char>(first[i].label));
+        visitWords(targetOf(state, first[i]), prefix, visit);
+        prefix.pop_back();
+    }
+}
+
+
+// suggestFrom() adds to suggestions the words that begin with prefix (which
+// reached the given state) and continue with word[i..], after at most one
+// edit if canEdit is true.  Every edit is tried only where the DAWG has an
+// edge for it, so no branch is explored unless its prefix is the prefix of
+// some word.
+void DawgSet::suggestFrom(
+    StateRef state, std::string_view word, std::size_t i, bool canEdit,
+    std::string& prefix, std::vector<std::string>& suggestions) const
+{
+    if (i == word.size() && isFinal(state))
+    {
+        suggestions.push_back(prefix);
+    }
+
+    StateRef next = state;
+
+    if (i < word.size() && follow(next, static_cast<unsigned char>(word[i])))
+    {
+        prefix.push_back(word[i]);
+        suggestFrom(next, word, i + 1, canEdit, prefix, suggestions);
+        prefix.pop_back();
+    }
+
+    if (!canEdit)
+    {
+        return;
+    }
+
+    // Deleting word[i]
+    if (i < word.size())
+    {
+        suggestFrom(state, word, i + 1, false, prefix, suggestions);
+    }
+
+    // Inserting a character before word[i], or replacing word[i] with one
+    auto [first, edgeCount] = edgesOf(state);
+
+    for (std::size_t e = 0; e < edgeCount; ++e)
+    {
+        next = targetOf(state, first[e]);
+        prefix.push_back(static_cast<char>(first[e].label));
+
+        suggestFrom(next, word, i, false, prefix, suggestions);
+
+        if (i < word.size() && prefix.back() != word[i])
+        {
+            suggestFrom(next, word, i + 1, false, prefix, suggestions);
+        }
+
+        prefix.pop_back();
+    }
+
+    // Swapping word[i] and word[i + 1]
+    next = state;
+
+    if (i + 1 < word.size() && word[i] != word[i + 1]
+        && follow(next, static_cast<unsigned char>(word[i + 1]))
+        && follow(next, static_cast<unsigned char>(word[i])))
+    {
+        prefix.push_back(word[i + 1]);
+        prefix.push_back(word[i]);
+        suggestFrom(next, word, i + 2, false, prefix, suggestions);
+        prefix.resize(prefix.size() - 2);
+    }
+}
+
+
+// walkWithinDistance() adds to suggestions the words within maxDistance of
+// the given word that begin with prefix (which reached the given state)
+// followed by at least one more character.  The last row in rows is the
+// one for prefix.  Since the edges are visited in order and each word has
+// only one path, the suggestions are added in ascending order.
+void DawgSet::walkWithinDistance(
+    StateRef state, std::string_view word, unsigned int maxDistance,
+    std::string& prefix, std::vector<unsigned int>& rows,
+    std::vector<std::string>& suggestions) const
+{
+    std::size_t width = word.size() + 1;
+    std::size_t depth = prefix.size() + 1;
+    std::size_t previous = (depth - 1) * width;
+    std::size_t current = depth * width;
+
+    rows.resize(current + width);
+
+    auto [first, edgeCount] = edgesOf(state);
+
+    for (std::size_t e = 0; e < edgeCount; ++e)
+    {
+        char c = static_cast<char>(first[e].label);
+
+        rows[current] = static_cast<unsigned int>(depth);
+        unsigned int rowMinimum = rows[current];
+
+        for (std::size_t j = 1; j < width; ++j)
+        {
+            unsigned int cost = c == word[j - 1] ? 0 : 1;
+
+            unsigned int distance = std::min({
+                rows[previous + j] + 1, rows[current + j - 1] + 1, rows[previous + j - 1] + cost});
+
+            if (depth > 1 && j > 1 && c == word[j - 2] && prefix.back() == word[j - 1])
+            {
+                distance = std::min(distance, rows[previous - width + j - 2] + 1);
+            }
+
+            rows[current + j] = distance;
+            rowMinimum = std::min(rowMinimum, distance);
+        }
+
+        // No entry in a later row can be smaller than the smallest in this
+        // one, so if that's too large, nothing further down is close enough.
+        if (rowMinimum > maxDistance)
+        {
+            continue;
+        }
+
+        StateRef next = targetOf(state, first[e]);
+        prefix.push_back(c);
+
+        if (rows[current + width - 1] <= maxDistance && isFinal(next))
+        {
+            suggestions.push_back(prefix);
+        }
+
+        walkWithinDistance(next, word, maxDistance, prefix, rows, suggestions);
+        prefix.pop_back();
+    }
+}
@@ -0,0 +1,224 @@
+// DawgSet.hpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A DawgSet is an implementation of a Set<std::string> that stores its
+// words in a minimal "directed acyclic word graph," or DAWG: a trie in
+// which any two nodes with the same set of endings have been merged into
+// one.  Like a trie, it shares the prefixes of its words; unlike one, it
+// shares their suffixes, too, so a dictionary full of words ending in
+// "-ING," "-ATION," and "-NESS" takes far fewer nodes than a trie, and
+// far less memory than any set storing each word separately.
+//
+// The DAWG is built with Daciuk's incremental algorithm for sorted input.
+// The nodes along the path of the most recently added word are kept "open"
+// -- still able to change -- and the others are "frozen"; when a word is
+// added, the open nodes beyond the prefix it shares with the previous word
+// are frozen, each one being merged with an equivalent frozen node if
+// there is one (found with a hash table of the frozen nodes), and new open
+// nodes are made for the rest of the word.  A frozen node never changes
+// again, so its edges are stored contiguously, sorted by label, in one
+// array shared by all of them.
+//
+// So, adding words in ascending order (as when they're loaded from a
+// sorted word list) takes O(L) amortized time per word, where L is the
+// word's length.  A word added out of order can't be added this way, so
+// the DAWG is rebuilt with it, which takes time linear in the total length
+// of the words; this is only suitable for occasional additions.  Searches
+// take O(L log A) time, where A is the size of the alphabet, no matter how
+// many words there are.
+//
+// A DawgSet is also a SuggestionEngine (see SuggestionEngine.hpp), since
+// the DAWG can find suggestions far faster than looking up candidates one
+// at a time: it tries each edit only where the graph has an edge for it,
+// abandoning any candidate as soon as its prefix isn't the prefix of a
+// word, so the time taken depends on how many prefixes of words are near
+// the misspelled word, rather than on the alphabet's size times the word's
+// length.  To use it, give it to a WordChecker as its SuggestionEngine, as
+// well as its Set.
+
+#ifndef DAWGSET_HPP
+#define DAWGSET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "KeyLookup.hpp"
+#include "Set.hpp"
+#include "SuggestionEngine.hpp"
+
+
+
+class DawgSet : public Set<std::string>, public SuggestionEngine
+{
+public:
+    // Initializes a DawgSet to be empty.
+    DawgSet();
+
+    // Initializes a DawgSet to contain the words in the range [first,
+    // last), which needn't be sorted or distinct.
+    template <
+        typename InputIterator,
+        typename = typename std::iterator_traits<InputIterator>::iterator_category>
+    DawgSet(InputIterator first, InputIterator last);
+
+
+    bool isImplemented() const noexcept override;
+
+
+    // add() adds a word to the set.  If the word is already in the set,
+    // this function has no effect.  If it's larger than every word in the
+    // set, it runs in O(L) amortized time; otherwise, the DAWG is rebuilt,
+    // in O(n L) time.
+    void add(const std::string& word) override;
+
+
+    // contains() returns true if the given word is already in the set,
+    // false otherwise.  This function runs in O(L log A) time.
+    bool contains(const std::string& word) const override;
+
+
+    // contains() can also be given a key of another type that can be
+    // compared to the words directly.  (See KeyLookup.hpp.)
+    template <typename KeyType, typename = impl_::Set__TransparentKey<std::string, KeyType>>
+    bool contains(const KeyType& key) const;
+
+
+    // size() returns the number of words in the set.
+    unsigned int size() const noexcept override;
+
+
+    // findSuggestions() returns the words reached by the same edits that a
+    // WordChecker tries on its own -- swapping two adjacent characters,
+    // inserting a character, deleting one, or replacing one -- except that
+    // any character may be inserted or replaced, not only the letters A-Z.
+    // Like a WordChecker's, the suggestions include the word itself, if
+    // it's in the set.
+    std::vector<std::string> findSuggestions(const std::string& word) const override;
+
+
+    // findWithinDistance() returns the words whose edit distance from the
+    // given word -- the number of insertions, deletions, replacements, and
+    // swaps of adjacent characters needed to turn one into the other -- is
+    // at most maxDistance, in ascending order.  It walks the DAWG from the
+    // root, computing one row of the edit distance table for each node
+    // along the way, and abandons any path on which every entry in the row
+    // exceeds maxDistance, since no word beginning that way can be close
+    // enough.  So it visits only the prefixes of words that are within
+    // maxDistance of some prefix of the given word, which are few, even for
+    // a maxDistance of 2 or 3.  (See LevenshteinEngine.hpp.)
+    std::vector<std::string> findWithinDistance(std::string_view word, unsigned int maxDistance) const;
+
+
+    // stateCount() returns the number of nodes in the DAWG, which is what
+    // determines its size.
+    std::size_t stateCount() const noexcept;
+
+
+private:
+    // A target of OPEN in an open node's edge leads to the next open node.
+    static constexpr std::uint32_t OPEN = 0xFFFFFFFF;
+
+    struct Edge
+    {
+        std::uint32_t target;
+        unsigned char label;
+    };
+
+    // A frozen node's edges are edges[firstEdge] through
+    // edges[firstEdge + edgeCount - 1].
+    struct FrozenState
+    {
+        std::uint32_t firstEdge;
+        std::uint16_t edgeCount;
+        bool final;
+    };
+
+    struct OpenState
+    {
+        bool final;
+        std::vector<Edge> edges;
+    };
+
+    // A StateRef refers to either an open or a frozen node.
+    struct StateRef
+    {
+        bool open;
+        std::uint32_t index;
+    };
+
+    std::vector<FrozenState> states;
+    std::vector<Edge> edges;
+
+    // openPath[d] is the node reached by the first d characters of
+    // lastWord; openPath[0] is the root, which is always open.
+    std::vector<OpenState> openPath;
+    std::string lastWord;
+
+    // An open-addressing hash table of the indices of the frozen nodes,
+    // with EMPTY in the unused slots, so that equivalent nodes can be found
+    // and merged.
+    static constexpr std::uint32_t EMPTY = 0xFFFFFFFF;
+    std::vector<std::uint32_t> registry;
+
+    unsigned int count;
+
+private:
+    void build(std::vector<std::string> words);
+    void clear();
+    void append(std::string_view word);
+    std::uint32_t freeze(const OpenState& state);
+    void growRegistry();
+    static std::uint64_t hashOf(bool final, const Edge* edges, std::size_t edgeCount) noexcept;
+
+    bool containsKey(std::string_view key) const;
+
+    bool isFinal(StateRef state) const noexcept;
+    std::pair<const Edge*, std::size_t> edgesOf(StateRef state) const noexcept;
+    bool follow(StateRef& state, unsigned char label) const noexcept;
+    StateRef targetOf(StateRef from, const Edge& edge) const noexcept;
+
+    template <typename Visit>
+    void visitWords(StateRef state, std::string& prefix, Visit&& visit) const;
+
+    void suggestFrom(
+        StateRef state, std::string_view word, std::size_t i, bool canEdit,
+        std::string& prefix, std::vector<std::string>& suggestions) const;
+
+    void walkWithinDistance(
+        StateRef state, std::string_view word, unsigned int maxDistance,
+        std::string& prefix, std::vector<unsigned int>& rows,
+        std::vector<std::string>& suggestions) const;
+};
+
+
+
+template <typename InputIterator, typename>
+DawgSet::DawgSet(InputIterator first, InputIterator last)
+    : DawgSet{}
+{
+    std::vector<std::string> words;
+
+    for (; first != last; ++first)
+    {
+        words.emplace_back(*first);
+    }
+
+    build(std::move(words));
+}
+
+
+template <typename KeyType, typename>
+bool DawgSet::contains(const KeyType& key) const
+{
+    return containsKey(std::string_view{key});
+}
+
+
+
+#endif
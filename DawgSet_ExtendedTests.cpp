@@ -0,0 +1,142 @@
+// DawgSet_ExtendedTests.cpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// These unit tests check that a DawgSet contains exactly the words added
+// to it, in whatever order they're added, that words with common endings
+// share nodes, and that its suggestions are the ones a WordChecker would
+// have found.
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <gtest/gtest.h>
+#include "DawgSet.hpp"
+#include "HashSet.hpp"
+#include "WordChecker.hpp"
+
+
+namespace
+{
+    std::string randomWord(std::default_random_engine& engine, int letters)
+    {
+        std::uniform_int_distribution<int> length{0, 7};
+        std::uniform_int_distribution<int> letter{0, letters - 1};
+
+        std::string word(length(engine), ' ');
+
+        for (char& c : word)
+        {
+            c = static_cast<char>('A' + letter(engine));
+        }
+
+        return word;
+    }
+}
+
+
+TEST(DawgSet_ExtendedTests, containsWordsAddedInAnyOrder)
+{
+    std::default_random_engine engine{46};
+    std::set<std::string> expected;
+    DawgSet s;
+
+    for (int i = 0; i < 300; ++i)
+    {
+        std::string word = randomWord(engine, 4);
+        expected.insert(word);
+        s.add(word);
+
+        ASSERT_EQ(expected.size(), s.size());
+    }
+
+    for (int i = 0; i < 2000; ++i)
+    {
+        std::string word = randomWord(engine, 5);
+        ASSERT_EQ(expected.count(word) == 1, s.contains(word));
+    }
+
+    // The DAWG is minimal however it was built, so building it from the
+    // same words in order gives one of the same size.
+    DawgSet sorted{expected.begin(), expected.end()};
+    EXPECT_EQ(s.size(), sorted.size());
+    EXPECT_EQ(s.stateCount(), sorted.stateCount());
+}
+
+
+TEST(DawgSet_ExtendedTests, wordsWithCommonEndingsShareNodes)
+{
+    std::vector<std::string> stems{"CHECK", "SPELL", "LOAD", "BUILD", "SEARCH", "WALK", "TEST", "PRINT"};
+    std::vector<std::string> endings{"", "S", "ED", "ER", "ERS", "ING", "INGS"};
+
+    DawgSet s;
+    std::size_t totalLength = 0;
+
+    for (const std::string& stem : stems)
+    {
+        for (const std::string& ending : endings)
+        {
+            s.add(stem + ending);
+            totalLength += stem.size() + ending.size();
+        }
+    }
+
+    EXPECT_EQ(stems.size() * endings.size(), s.size());
+    EXPECT_TRUE(s.contains("SPELLINGS"));
+    EXPECT_TRUE(s.contains(std::string_view{"WALKERS"}));
+    EXPECT_FALSE(s.contains("WALKINGED"));
+    EXPECT_FALSE(s.contains("SPEL"));
+
+    // The stems' nodes, plus one shared set of nodes for the endings.
+    EXPECT_LT(s.stateCount(), totalLength / 5);
+}
+
+
+TEST(DawgSet_ExtendedTests, canHoldTheEmptyWord)
+{
+    DawgSet s;
+    s.add("B");
+    s.add("");
+    s.add("A");
+
+    EXPECT_EQ(3, s.size());
+    EXPECT_TRUE(s.contains(""));
+    EXPECT_TRUE(s.contains("A"));
+    EXPECT_FALSE(s.contains("AB"));
+}
+
+
+TEST(DawgSet_ExtendedTests, suggestsWhatAWordCheckerWould)
+{
+    std::default_random_engine engine{46};
+    DawgSet dawg;
+    HashSet<std::string, WyHash> words;
+
+    for (int i = 0; i < 400; ++i)
+    {
+        std::string word = randomWord(engine, 4);
+        dawg.add(word);
+        words.add(word);
+    }
+
+    WordChecker plainChecker{words};
+    WordChecker dawgChecker{words, dawg};
+
+    for (int i = 0; i < 500; ++i)
+    {
+        std::string word = randomWord(engine, 5);
+
+        if (!word.empty())
+        {
+            ASSERT_EQ(plainChecker.findSuggestions(word), dawgChecker.findSuggestions(word));
+        }
+    }
+
+    std::vector<std::string> expected{"ABCD", "ABDC"};
+    DawgSet s{expected.begin(), expected.end()};
+    EXPECT_EQ(expected, s.findSuggestions("ABCD"));
+}
@@ -0,0 +1,212 @@
+// DeletionIndex.cpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// Implementation of the DeletionIndex class.
+
+#include "DeletionIndex.hpp"
+#include <algorithm>
+#include <utility>
+
+
+
+namespace
+{
+    // editDistance() returns the number of insertions, deletions,
+    // replacements, and swaps of adjacent characters needed to turn a into
+    // b (the "optimal string alignment" distance), or limit + 1 if it's
+    // more than limit.  rows is scratch space, so that checking many words
+    // needn't allocate for each one.
+    unsigned int editDistance(
+        std::string_view a, std::string_view b, unsigned int limit,
+        std::vector<unsigned int>& rows)
+    {
+        std::size_t width = b.size() + 1;
+        rows.assign(width * 3, 0);
+
+        // Rows i - 2, i - 1, and i of the table take turns in the three
+        // thirds of rows.
+        unsigned int* previous2 = rows.data();
+        unsigned int* previous = previous2 + width;
+        unsigned int* current = previous + width;
+
+        for (std::size_t j = 0; j < width; ++j)
+        {
+            previous[j] = static_cast<unsigned int>(j);
+        }
+
+        for (std::size_t i = 1; i <= a.size(); ++i)
+        {
+            current[0] = static_cast<unsigned int>(i);
+            unsigned int rowMinimum = current[0];
+
+            for (std::size_t j = 1; j < width; ++j)
+            {
+                unsigned int cost = a[i - 1] == b[j - 1] ? 0 : 1;
+
+                current[j] = std::min({previous[j] + 1, current[j - 1] + 1, previous[j - 1] + cost});
+
+                if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1])
+                {
+                    current[j] = std::min(current[j], previous2[j - 2] + 1);
+                }
+
+                rowMinimum = std::min(rowMinimum, current[j]);
+            }
+
+            // The distance can never be smaller than the smallest entry in
+            // any one row.
+            if (rowMinimum > limit)
+            {
+                return limit + 1;
+            }
+
+            std::swap(previous2, previous);
+            std::swap(previous, current);
+        }
+
+        return std::min(previous[width - 1], limit + 1);
+    }
+
+
+    // collectDeletesFrom() adds the hash of the given string, and of every
+    // string made by deleting up to "remaining" more of its characters at
+    // or after index "from," to hashes.  Deletions are made in order from
+    // left to right, so that each set of positions is deleted only once.
+    void collectDeletesFrom(
+        std::string& s, std::size_t from, unsigned int remaining,
+        const WyHash& hash, std::vector<std::uint64_t>& hashes)
+    {
+        hashes.push_back(hash(s));
+
+        if (remaining == 0)
+        {
+            return;
+        }
+
+        for (std::size_t i = from; i < s.size(); ++i)
+        {
+            char deleted = s[i];
+            s.erase(i, 1);
+            collectDeletesFrom(s, i, remaining - 1, hash, hashes);
+            s.insert(i, 1, deleted);
+        }
+    }
+}
+
+
+
+std::vector<std::string> DeletionIndex::findSuggestions(const std::string& word) const
+{
+    std::vector<std::uint64_t> hashes;
+    collectDeletes(word, hashes);
+
+    std::vector<std::uint32_t> candidates;
+
+    for (std::uint64_t deleteHash : hashes)
+    {
+        auto [begin, end] = std::equal_range(deleteHashes.begin(), deleteHashes.end(), deleteHash);
+
+        candidates.insert(
+            candidates.end(),
+            deleteWords.begin() + (begin - deleteHashes.begin()),
+            deleteWords.begin() + (end - deleteHashes.begin()));
+    }
+
+    // The words are numbered in sorted order, so the suggestions come out
+    // sorted, too.
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    std::vector<std::string> suggestions;
+    std::vector<unsigned int> rows;
+
+    for (std::uint32_t candidate : candidates)
+    {
+        std::string_view suggestion = wordAt(candidate);
+
+        std::size_t lengthDifference = suggestion.size() > word.size()
+            ? suggestion.size() - word.size()
+            : word.size() - suggestion.size();
+
+        if (lengthDifference <= maxDistance
+            && editDistance(word, suggestion, maxDistance, rows) <= maxDistance)
+        {
+            suggestions.emplace_back(suggestion);
+        }
+    }
+
+    return suggestions;
+}
+
+
+std::size_t DeletionIndex::wordCount() const noexcept
+{
+    return wordStarts.size() - 1;
+}
+
+
+std::size_t DeletionIndex::deleteCount() const noexcept
+{
+    return deleteHashes.size();
+}
+
+
+void DeletionIndex::build(std::vector<std::string> words)
+{
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> records;
+    std::vector<std::uint64_t> hashes;
+
+    wordStarts.reserve(words.size() + 1);
+
+    for (std::uint32_t i = 0; i < words.size(); ++i)
+    {
+        wordStarts.push_back(static_cast<std::uint32_t>(wordText.size()));
+        wordText.append(words[i]);
+
+        hashes.clear();
+        collectDeletes(words[i], hashes);
+
+        for (std::uint64_t deleteHash : hashes)
+        {
+            records.emplace_back(deleteHash, i);
+        }
+    }
+
+    wordStarts.push_back(static_cast<std::uint32_t>(wordText.size()));
+
+    std::sort(records.begin(), records.end());
+
+    deleteHashes.reserve(records.size());
+    deleteWords.reserve(records.size());
+
+    for (const auto& [deleteHash, word] : records)
+    {
+        deleteHashes.push_back(deleteHash);
+        deleteWords.push_back(word);
+    }
+}
+
+
+// collectDeletes() sets hashes to the hashes of the deletes of the given
+// word's prefix, sorted and without duplicates.  (A word with repeated
+// characters has some deletes more than once.)
+void DeletionIndex::collectDeletes(std::string_view word, std::vector<std::uint64_t>& hashes) const
+{
+    std::string prefix{word.substr(0, prefixLength)};
+    collectDeletesFrom(prefix, 0, maxDistance, hash, hashes);
+
+    std::sort(hashes.begin(), hashes.end());
+    hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+}
+
+
+std::string_view DeletionIndex::wordAt(std::uint32_t index) const noexcept
+{
+    return std::string_view{wordText}.substr(wordStarts[index], wordStarts[index + 1] - wordStarts[index]);
+}
+
@@ -0,0 +1,121 @@
+// DeletionIndex.hpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A DeletionIndex is a SuggestionEngine that finds the words of a
+// dictionary within a given edit distance of a misspelled word, in the
+// style of SymSpell's "symmetric delete" algorithm, rather than generating
+// and looking up every possible edit of it.
+//
+// Two words are within edit distance k of each other (counting insertions,
+// deletions, replacements, and swaps of adjacent characters) only if
+// deleting at most k characters from each of them can make them the same.
+// So, as it's built, the index records every way of deleting up to k
+// characters from each word of the dictionary -- its "deletes" -- along
+// with the word each came from.  Finding suggestions for a word means
+// generating its own deletes, of which there are O(L) for k = 1 and O(L^2)
+// for k = 2 (where L is the word's length), no matter how large the
+// alphabet is; looking each of them up; and checking the edit distance of
+// each word they lead to.  Since no alphabet is involved, suggestions can
+// contain any characters, not only the letters A-Z that WordChecker tries.
+//
+// Only a 64-bit hash of each delete is stored, so a record takes 12 bytes;
+// two deletes with the same hash only make for one more word to check.
+// The records are kept in one array, sorted by hash, and looked up with a
+// binary search.
+//
+// How large the index is, and how long it takes to build, depends on two
+// settings given to its constructor:
+//
+// * The maximum edit distance k.  A word of length L has about C(L, k)
+//   deletes, so each step up in k makes the index several times larger.
+//
+// * The prefix length.  Only the deletes of each word's first prefixLength
+//   characters are recorded (and only those of the misspelled word's are
+//   looked up), which caps the number of deletes per word regardless of
+//   its length.  Two words within distance k have prefixes that share a
+//   delete, too, so no suggestions are lost; a shorter prefix just means
+//   more words that must be checked.
+
+#ifndef DELETIONINDEX_HPP
+#define DELETIONINDEX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "Hashing.hpp"
+#include "SuggestionEngine.hpp"
+
+
+
+class DeletionIndex : public SuggestionEngine
+{
+public:
+    // Builds an index of the words in the range [first, last), which
+    // suggests the words within maxDistance edits of a misspelled word.
+    template <typename InputIterator>
+    DeletionIndex(
+        InputIterator first, InputIterator last,
+        unsigned int maxDistance = 1, std::size_t prefixLength = 7);
+
+
+    // findSuggestions() returns the words within the maximum edit distance
+    // of the given word, including the word itself if it's in the index.
+    std::vector<std::string> findSuggestions(const std::string& word) const override;
+
+
+    // wordCount() returns the number of distinct words in the index.
+    std::size_t wordCount() const noexcept;
+
+
+    // deleteCount() returns the number of deletes recorded in the index,
+    // which is what determines its size.
+    std::size_t deleteCount() const noexcept;
+
+
+private:
+    unsigned int maxDistance;
+    std::size_t prefixLength;
+    WyHash hash;
+
+    // The words are sorted and stored end to end; word i begins at
+    // wordStarts[i] and ends where word i + 1 begins.
+    std::string wordText;
+    std::vector<std::uint32_t> wordStarts;
+
+    // deleteHashes is sorted, and deleteWords[i] is the word that the
+    // delete with hash deleteHashes[i] came from.
+    std::vector<std::uint64_t> deleteHashes;
+    std::vector<std::uint32_t> deleteWords;
+
+private:
+    void build(std::vector<std::string> words);
+    void collectDeletes(std::string_view word, std::vector<std::uint64_t>& hashes) const;
+    std::string_view wordAt(std::uint32_t index) const noexcept;
+};
+
+
+
+template <typename InputIterator>
+DeletionIndex::DeletionIndex(
+    InputIterator first, InputIterator last,
+    unsigned int maxDistance, std::size_t prefixLength)
+    : maxDistance{maxDistance}, prefixLength{prefixLength}
+{
+    std::vector<std::string> words;
+
+    for (; first != last; ++first)
+    {
+        words.emplace_back(*first);
+    }
+
+    build(std::move(words));
+}
+
+
+
+#endif
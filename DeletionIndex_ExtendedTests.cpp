@@ -0,0 +1,159 @@
+// DeletionIndex_ExtendedTests.cpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// These unit tests check that a DeletionIndex suggests exactly the words
+// within its maximum edit distance, however long a prefix it's configured
+// with, and that a WordChecker given one suggests what the index does.
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <gtest/gtest.h>
+#include "DeletionIndex.hpp"
+#include "HashSet.hpp"
+#include "WordChecker.hpp"
+
+
+namespace
+{
+    // Counts insertions, deletions, replacements, and swaps of adjacent
+    // characters, the slow and obvious way.
+    unsigned int slowEditDistance(const std::string& a, const std::string& b)
+    {
+        std::vector<std::vector<unsigned int>> d(a.size() + 1, std::vector<unsigned int>(b.size() + 1));
+
+        for (std::size_t i = 0; i <= a.size(); ++i)
+        {
+            for (std::size_t j = 0; j <= b.size(); ++j)
+            {
+                if (i == 0 || j == 0)
+                {
+                    d[i][j] = static_cast<unsigned int>(i + j);
+                    continue;
+                }
+
+                d[i][j] = std::min({d[i - 1][j] + 1, d[i][j - 1] + 1, d[i - 1][j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1)});
+
+                if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1])
+                {
+                    d[i][j] = std::min(d[i][j], d[i - 2][j - 2] + 1);
+                }
+            }
+        }
+
+        return d[a.size()][b.size()];
+    }
+
+
+    std::string randomWord(std::default_random_engine& engine)
+    {
+        std::uniform_int_distribution<int> length{0, 9};
+        std::uniform_int_distribution<int> letter{0, 2};
+
+        std::string word(length(engine), ' ');
+
+        for (char& c : word)
+        {
+            c = static_cast<char>('A' + letter(engine));
+        }
+
+        return word;
+    }
+}
+
+
+TEST(DeletionIndex_ExtendedTests, suggestsTheWordsWithinTheMaximumDistance)
+{
+    // With only three letters, there are many words near each other.
+    std::default_random_engine engine{46};
+    std::vector<std::string> dictionary;
+
+    for (int i = 0; i < 500; ++i)
+    {
+        dictionary.push_back(randomWord(engine));
+    }
+
+    for (unsigned int maxDistance : {1, 2})
+    {
+        for (std::size_t prefixLength : {2, 7})
+        {
+            DeletionIndex index{dictionary.begin(), dictionary.end(), maxDistance, prefixLength};
+
+            for (int i = 0; i < 100; ++i)
+            {
+                std::string word = randomWord(engine);
+                std::vector<std::string> expected;
+
+                for (const std::string& candidate : dictionary)
+                {
+                    if (slowEditDistance(word, candidate) <= maxDistance)
+                    {
+                        expected.push_back(candidate);
+                    }
+                }
+
+                std::sort(expected.begin(), expected.end());
+                expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+
+                ASSERT_EQ(expected, index.findSuggestions(word));
+            }
+        }
+    }
+}
+
+
+TEST(DeletionIndex_ExtendedTests, shorterPrefixesRecordFewerDeletes)
+{
+    std::vector<std::string_view> dictionary{"SPELLING", "CHECKER", "SUGGESTION", "DICTIONARY"};
+
+    DeletionIndex full{dictionary.begin(), dictionary.end(), 2, 20};
+    DeletionIndex shortened{dictionary.begin(), dictionary.end(), 2, 4};
+
+    EXPECT_EQ(4, full.wordCount());
+    EXPECT_EQ(4, shortened.wordCount());
+    EXPECT_LT(shortened.deleteCount(), full.deleteCount());
+
+    std::vector<std::string> expected{"SUGGESTION"};
+    EXPECT_EQ(expected, full.findSuggestions("SUGESTOIN"));
+    EXPECT_EQ(expected, shortened.findSuggestions("SUGESTOIN"));
+    EXPECT_EQ(expected, shortened.findSuggestions("SUGGESTONI"));
+    EXPECT_TRUE(shortened.findSuggestions("XYZ").empty());
+}
+
+
+TEST(DeletionIndex_ExtendedTests, wordCheckersSuggestWhatTheirEngineDoes)
+{
+    std::vector<std::string> dictionary{
+        "CAT", "CART", "CAST", "CT", "ACT", "CAB", "BAT", "COAT", "AT", "CA", "SCAT"
+    };
+
+    HashSet<std::string, WyHash> words;
+
+    for (const std::string& word : dictionary)
+    {
+        words.add(word);
+    }
+
+    DeletionIndex index{dictionary.begin(), dictionary.end()};
+
+    WordChecker plainChecker{words};
+    WordChecker indexChecker{words, index};
+
+    // At distance 1, the index suggests what the WordChecker would have.
+    for (const char* word : {"CAT", "CT", "CART", "XYZ", "CATS", "AC", "TAC"})
+    {
+        EXPECT_EQ(plainChecker.findSuggestions(word), indexChecker.findSuggestions(word));
+    }
+
+    EXPECT_TRUE(indexChecker.wordExists("COAT"));
+    EXPECT_FALSE(indexChecker.wordExists("COT"));
+
+    // An empty word is within distance 1 only of words of one character,
+    // and there are none.
+    std::vector<std::string> none;
+    EXPECT_EQ(none, indexChecker.findSuggestions(""));
+}
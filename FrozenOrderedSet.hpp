@@ -0,0 +1,539 @@
+// FrozenOrderedSet.hpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A FrozenOrderedSet is an implementation of a Set meant for sets that are
+// built once and then searched many times without changing, such as a
+// dictionary that's loaded at startup.  It can be built from any range of
+// elements -- most conveniently, from another ordered set, like an AVLSet
+// (see AVLSet::freeze()) -- and supports the same ordered queries as an
+// AVLSet, but searches it considerably faster.
+//
+// The elements are stored in one array, in "Eytzinger" order: the order of
+// a breadth-first traversal of a perfectly balanced binary search tree, so
+// that the root is at index 1 and the children of index k are at indices
+// 2k and 2k + 1.  There are no links to follow, and the first few levels
+// of the tree, which every search visits, are packed together at the front
+// of the array, where they stay in the cache.  A search descends with no
+// branches to mispredict (each step computes the next index from the
+// result of a comparison), and prefetches the part of the array that it
+// will reach a few levels further down while it works on the current one.
+//
+// For a FrozenOrderedSet<std::string>, a parallel array holds the first 8
+// bytes of each element, packed into a 64-bit integer so that comparing two
+// of them as integers compares those bytes in order.  Most comparisons made
+// by a search are decided by comparing these prefixes, which are compact
+// and contiguous, without following a pointer to the string's characters.
+//
+// add() works, but it rebuilds the whole layout in linear time, so it's
+// only suitable for occasional additions.
+
+#ifndef FROZENORDEREDSET_HPP
+#define FROZENORDEREDSET_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "KeyLookup.hpp"
+#include "Set.hpp"
+
+
+
+template <typename ElementType>
+class FrozenOrderedSet : public Set<ElementType>
+{
+public:
+    // A VisitFunction is a function that takes a reference to a const
+    // ElementType and returns no value.
+    using VisitFunction = std::function<void(const ElementType&)>;
+
+public:
+    // Initializes a FrozenOrderedSet to be empty.
+    FrozenOrderedSet();
+
+    // Initializes a FrozenOrderedSet to contain the elements in the range
+    // [first, last), which needn't be sorted or distinct, though building
+    // the set takes only linear time when they are (e.g., when they come
+    // from another ordered set).
+    template <
+        typename InputIterator,
+        typename = typename std::iterator_traits<InputIterator>::iterator_category>
+    FrozenOrderedSet(InputIterator first, InputIterator last);
+
+
+    bool isImplemented() const noexcept override;
+
+
+    // add() adds an element to the set.  If the element is already in the
+    // set, this function has no effect.  Since the layout has to be rebuilt
+    // to make room for the element, this function runs in O(n) time.
+    void add(const ElementType& element) override;
+
+
+    // contains() returns true if the given element is already in the set,
+    // false otherwise.  This function runs in O(log n) time.
+    bool contains(const ElementType& element) const override;
+
+
+    // contains() can also be given a key of another type that can be
+    // compared to the elements directly.  (See KeyLookup.hpp.)
+    template <typename KeyType, typename = impl_::Set__TransparentKey<ElementType, KeyType>>
+    bool contains(const KeyType& key) const;
+
+
+    // size() returns the number of elements in the set.
+    unsigned int size() const noexcept override;
+
+
+    // lowerBound(), upperBound(), visitRange(), and visitPrefix() behave
+    // the same way as they do in an AVLSet, with the same running times.
+    const ElementType* lowerBound(const ElementType& key) const;
+    const ElementType* upperBound(const ElementType& key) const;
+
+    template <typename KeyType, typename = impl_::Set__TransparentKey<ElementType, KeyType>>
+    const ElementType* lowerBound(const KeyType& key) const;
+
+    template <typename KeyType, typename = impl_::Set__TransparentKey<ElementType, KeyType>>
+    const ElementType* upperBound(const KeyType& key) const;
+
+    void visitRange(const ElementType& low, const ElementType& high, VisitFunction visit) const;
+
+    template <
+        typename E = ElementType,
+        typename = std::enable_if_t<std::is_same_v<E, std::string>>>
+    void visitPrefix(std::string_view prefix, VisitFunction visit) const;
+
+
+    // inorder() calls the given "visit" function for each of the elements
+    // in the set, in ascending order.
+    void inorder(VisitFunction visit) const;
+
+
+private:
+    // Whether the elements have prefixes stored alongside them.
+    static constexpr bool HAS_PREFIXES = std::is_same_v<ElementType, std::string>;
+
+    // How many levels below the current one a search prefetches.  Sixteen
+    // consecutive prefixes (or elements) begin four levels down.
+    static constexpr std::size_t PREFETCH_LEVELS = 4;
+
+    // elements[k], for k from 1 to the size, is the element at index k in
+    // Eytzinger order; elements[0] is unused.  When HAS_PREFIXES is true,
+    // prefixes[k] is the prefix of elements[k].
+    std::vector<ElementType> elements;
+    std::vector<std::uint64_t> prefixes;
+
+private:
+    void build(std::vector<ElementType>&& sorted);
+
+    template <typename KeyType>
+    std::size_t lowerBoundIndex(const KeyType& key) const;
+
+    template <typename KeyType>
+    std::size_t upperBoundIndex(const KeyType& key) const;
+
+    void prefetch(std::size_t index) const noexcept;
+
+    std::size_t count() const noexcept;
+    std::size_t first() const noexcept;
+    std::size_t successor(std::size_t index) const noexcept;
+    const ElementType* elementAt(std::size_t index) const noexcept;
+};
+
+
+
+namespace impl_
+{
+    // FrozenOrderedSet__prefix() packs the first 8 bytes of a string into an
+    // integer, most significant byte first and padded with zero bytes, so
+    // that if one string's prefix is less than another's, the string is
+    // less, too.  (If the prefixes are equal, the strings must be compared.)
+    inline std::uint64_t FrozenOrderedSet__prefix(std::string_view s) noexcept
+    {
+        std::uint64_t prefix = 0;
+        std::size_t length = s.length() < 8 ? s.length() : 8;
+
+        for (std::size_t i = 0; i < length; ++i)
+        {
+            prefix |= static_cast<std::uint64_t>(static_cast<unsigned char>(s[i])) << (56 - 8 * i);
+        }
+
+        return prefix;
+    }
+
+
+    // FrozenOrderedSet__trailingOnes() returns the number of consecutive
+    // one bits at the bottom of the given value.
+    inline unsigned int FrozenOrderedSet__trailingOnes(std::size_t value) noexcept
+    {
+#if defined(__GNUC__)
+        return static_cast<unsigned int>(__builtin_ctzll(~static_cast<unsigned long long>(value)));
+#else
+        unsigned int ones = 0;
+
+        while ((value & 1) != 0)
+        {
+            value >>= 1;
+            ++ones;
+        }
+
+        return ones;
+#endif
+    }
+}
+
+
+template <typename ElementType>
+FrozenOrderedSet<ElementType>::FrozenOrderedSet()
+{
+    build(std::vector<ElementType>{});
+}
+
+
+template <typename ElementType>
+template <typename InputIterator, typename>
+FrozenOrderedSet<ElementType>::FrozenOrderedSet(InputIterator first, InputIterator last)
+{
+    std::vector<ElementType> sorted(first, last);
+
+    if (!std::is_sorted(sorted.begin(), sorted.end()))
+    {
+        std::sort(sorted.begin(), sorted.end());
+    }
+
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    build(std::move(sorted));
+}
+
+
+template <typename ElementType>
+bool FrozenOrderedSet<ElementType>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename ElementType>
+void FrozenOrderedSet<ElementType>::add(const ElementType& element)
+{
+    if (contains(element))
+    {
+        return;
+    }
+
+    std::vector<ElementType> sorted;
+    sorted.reserve(count() + 1);
+
+    bool added = false;
+
+    for (std::size_t k = first(); k != 0; k = successor(k))
+    {
+        if (!added && element < elements[k])
+        {
+            sorted.push_back(element);
+            added = true;
+        }
+
+        sorted.push_back(std::move(elements[k]));
+    }
+
+    if (!added)
+    {
+        sorted.push_back(element);
+    }
+
+    build(std::move(sorted));
+}
+
+
+template <typename ElementType>
+bool FrozenOrderedSet<ElementType>::contains(const ElementType& element) const
+{
+    std::size_t k = lowerBoundIndex(element);
+    return k != 0 && elements[k] == element;
+}
+
+
+template <typename ElementType>
+template <typename KeyType, typename>
+bool FrozenOrderedSet<ElementType>::contains(const KeyType& key) const
+{
+    std::string_view view{key};
+    std::size_t k = lowerBoundIndex(view);
+
+    return k != 0 && elements[k] == view;
+}
+
+
+template <typename ElementType>
+unsigned int FrozenOrderedSet<ElementType>::size() const noexcept
+{
+    return static_cast<unsigned int>(count());
+}
+
+
+template <typename ElementType>
+const ElementType* FrozenOrderedSet<ElementType>::lowerBound(const ElementType& key) const
+{
+    return elementAt(lowerBoundIndex(key));
+}
+
+
+template <typename ElementType>
+const ElementType* FrozenOrderedSet<ElementType>::upperBound(const ElementType& key) const
+{
+    return elementAt(upperBoundIndex(key));
+}
+
+
+template <typename ElementType>
+template <typename KeyType, typename>
+const ElementType* FrozenOrderedSet<ElementType>::lowerBound(const KeyType& key) const
+{
+    return elementAt(lowerBoundIndex(std::string_view{key}));
+}
+
+
+template <typename ElementType>
+template <typename KeyType, typename>
+const ElementType* FrozenOrderedSet<ElementType>::upperBound(const KeyType& key) const
+{
+    return elementAt(upperBoundIndex(std::string_view{key}));
+}
+
+
+template <typename ElementType>
+void FrozenOrderedSet<ElementType>::visitRange(
+    const ElementType& low, const ElementType& high, VisitFunction visit) const
+{
+    for (std::size_t k = lowerBoundIndex(low); k != 0 && elements[k] < high; k = successor(k))
+    {
+        visit(elements[k]);
+    }
+}
+
+
+template <typename ElementType>
+template <typename E, typename>
+void FrozenOrderedSet<ElementType>::visitPrefix(std::string_view prefix, VisitFunction visit) const
+{
+    for (std::size_t k = lowerBoundIndex(prefix);
+         k != 0 && elements[k].compare(0, prefix.size(), prefix) == 0;
+         k = successor(k))
+    {
+        visit(elements[k]);
+    }
+}
+
+
+template <typename ElementType>
+void FrozenOrderedSet<ElementType>::inorder(VisitFunction visit) const
+{
+    for (std::size_t k = first(); k != 0; k = successor(k))
+    {
+        visit(elements[k]);
+    }
+}
+
+
+// build() lays out the given elements, which must be in ascending order
+// and distinct, in Eytzinger order.  Visiting the indices of the implicit
+// tree in order (as successor() does) and assigning the elements to them
+// one after another places every element where a search expects it.
+template <typename ElementType>
+void FrozenOrderedSet<ElementType>::build(std::vector<ElementType>&& sorted)
+{
+    std::vector<ElementType> layout(sorted.size() + 1);
+    std::vector<std::uint64_t> layoutPrefixes;
+
+    elements.swap(layout);
+
+    if constexpr (HAS_PREFIXES)
+    {
+        layoutPrefixes.resize(sorted.size() + 1);
+    }
+
+    prefixes.swap(layoutPrefixes);
+
+    std::size_t k = first();
+
+    for (ElementType& element : sorted)
+    {
+        if constexpr (HAS_PREFIXES)
+        {
+            prefixes[k] = impl_::FrozenOrderedSet__prefix(element);
+        }
+
+        elements[k] = std::move(element);
+        k = successor(k);
+    }
+}
+
+
+// lowerBoundIndex() returns the index of the smallest element that isn't
+// less than the given key, or 0 if there is none.  The search moves from
+// index k to 2k or 2k + 1 until it falls off the bottom of the tree; each
+// move to 2k + 1 (a "right turn") appends a 1 bit to k.  The bound is the
+// last node where the search turned left, which is found by discarding the
+// trailing right turns and that last left turn.
+template <typename ElementType>
+template <typename KeyType>
+std::size_t FrozenOrderedSet<ElementType>::lowerBoundIndex(const KeyType& key) const
+{
+    const std::size_t n = count();
+    std::size_t k = 1;
+
+    if constexpr (HAS_PREFIXES)
+    {
+        const std::uint64_t keyPrefix = impl_::FrozenOrderedSet__prefix(key);
+
+        while (k <= n)
+        {
+            prefetch(k << PREFETCH_LEVELS);
+
+            bool less = prefixes[k] != keyPrefix
+                ? prefixes[k] < keyPrefix
+                : elements[k] < key;
+
+            k = 2 * k + static_cast<std::size_t>(less);
+        }
+    }
+    else
+    {
+        while (k <= n)
+        {
+            prefetch(k << PREFETCH_LEVELS);
+            k = 2 * k + static_cast<std::size_t>(elements[k] < key);
+        }
+    }
+
+    return k >> (impl_::FrozenOrderedSet__trailingOnes(k) + 1);
+}
+
+
+// upperBoundIndex() returns the index of the smallest element that is
+// greater than the given key, or 0 if there is none, in the same way that
+// lowerBoundIndex() does.
+template <typename ElementType>
+template <typename KeyType>
+std::size_t FrozenOrderedSet<ElementType>::upperBoundIndex(const KeyType& key) const
+{
+    const std::size_t n = count();
+    std::size_t k = 1;
+
+    if constexpr (HAS_PREFIXES)
+    {
+        const std::uint64_t keyPrefix = impl_::FrozenOrderedSet__prefix(key);
+
+        while (k <= n)
+        {
+            prefetch(k << PREFETCH_LEVELS);
+
+            bool notGreater = prefixes[k] != keyPrefix
+                ? prefixes[k] < keyPrefix
+                : !(key < elements[k]);
+
+            k = 2 * k + static_cast<std::size_t>(notGreater);
+        }
+    }
+    else
+    {
+        while (k <= n)
+        {
+            prefetch(k << PREFETCH_LEVELS);
+            k = 2 * k + static_cast<std::size_t>(!(key < elements[k]));
+        }
+    }
+
+    return k >> (impl_::FrozenOrderedSet__trailingOnes(k) + 1);
+}
+
+
+// prefetch() asks the processor to start loading the part of the layout
+// beginning at the given index, if there is one, into the cache.  The
+// prefixes are what a search compares first, so they're what it fetches.
+template <typename ElementType>
+void FrozenOrderedSet<ElementType>::prefetch(std::size_t index) const noexcept
+{
+#if defined(__GNUC__)
+    if (index < elements.size())
+    {
+        if constexpr (HAS_PREFIXES)
+        {
+            __builtin_prefetch(prefixes.data() + index);
+        }
+        else
+        {
+            __builtin_prefetch(elements.data() + index);
+        }
+    }
+#else
+    static_cast<void>(index);
+#endif
+}
+
+
+template <typename ElementType>
+std::size_t FrozenOrderedSet<ElementType>::count() const noexcept
+{
+    return elements.size() - 1;
+}
+
+
+// first() returns the index of the smallest element: the leftmost node of
+// the implicit tree, or 0 if the tree is empty.
+template <typename ElementType>
+std::size_t FrozenOrderedSet<ElementType>::first() const noexcept
+{
+    std::size_t k = 1;
+
+    while (2 * k <= count())
+    {
+        k *= 2;
+    }
+
+    return k <= count() ? k : 0;
+}
+
+
+// successor() returns the index of the next larger element after the one
+// at the given index, or 0 if it's the largest: the leftmost node of its
+// right subtree if it has one, or else the parent of the nearest ancestor
+// (including itself) that is a left child.
+template <typename ElementType>
+std::size_t FrozenOrderedSet<ElementType>::successor(std::size_t index) const noexcept
+{
+    if (2 * index + 1 <= count())
+    {
+        index = 2 * index + 1;
+
+        while (2 * index <= count())
+        {
+            index *= 2;
+        }
+
+        return index;
+    }
+
+    return index >> (impl_::FrozenOrderedSet__trailingOnes(index) + 1);
+}
+
+
+template <typename ElementType>
+const ElementType* FrozenOrderedSet<ElementType>::elementAt(std::size_t index) const noexcept
+{
+    return index == 0 ? nullptr : &elements[index];
+}
+
+
+
+#endif
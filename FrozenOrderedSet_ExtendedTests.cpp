@@ -0,0 +1,143 @@
+// FrozenOrderedSet_ExtendedTests.cpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// These unit tests check that a FrozenOrderedSet finds exactly the elements
+// it was built with, in order, however it was built.
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <gtest/gtest.h>
+#include "AVLSet.hpp"
+#include "FrozenOrderedSet.hpp"
+
+
+TEST(FrozenOrderedSet_ExtendedTests, emptySetsContainNothing)
+{
+    FrozenOrderedSet<int> s;
+
+    EXPECT_TRUE(s.isImplemented());
+    EXPECT_EQ(0, s.size());
+    EXPECT_FALSE(s.contains(0));
+    EXPECT_EQ(nullptr, s.lowerBound(0));
+    EXPECT_EQ(nullptr, s.upperBound(0));
+}
+
+
+TEST(FrozenOrderedSet_ExtendedTests, containsExactlyTheElementsOfEverySize)
+{
+    for (int n = 0; n <= 70; ++n)
+    {
+        std::vector<int> elements;
+
+        for (int i = 0; i < n; ++i)
+        {
+            elements.push_back(i * 2);
+        }
+
+        FrozenOrderedSet<int> s{elements.begin(), elements.end()};
+        ASSERT_EQ(n, s.size());
+
+        for (int i = -1; i <= n * 2; ++i)
+        {
+            ASSERT_EQ(i >= 0 && i % 2 == 0 && i < n * 2, s.contains(i)) << n << " " << i;
+
+            const int* lower = s.lowerBound(i);
+            const int* upper = s.upperBound(i);
+            int expectedLower = i < 0 ? 0 : (i + 1) / 2 * 2;
+            int expectedUpper = i < 0 ? 0 : i / 2 * 2 + 2;
+
+            ASSERT_EQ(expectedLower < n * 2, lower != nullptr);
+            ASSERT_EQ(expectedUpper < n * 2, upper != nullptr);
+
+            if (lower != nullptr)
+            {
+                ASSERT_EQ(expectedLower, *lower);
+            }
+
+            if (upper != nullptr)
+            {
+                ASSERT_EQ(expectedUpper, *upper);
+            }
+        }
+
+        std::vector<int> inorder;
+        s.inorder([&](const int& element) { inorder.push_back(element); });
+        ASSERT_EQ(elements, inorder);
+    }
+}
+
+
+TEST(FrozenOrderedSet_ExtendedTests, unsortedInputIsSortedAndDeduplicated)
+{
+    std::vector<std::string> words{"PEAR", "APPLE", "FIG", "APPLE", "KIWI", "FIG"};
+    FrozenOrderedSet<std::string> s{words.begin(), words.end()};
+
+    std::vector<std::string> inorder;
+    s.inorder([&](const std::string& element) { inorder.push_back(element); });
+
+    std::vector<std::string> expected{"APPLE", "FIG", "KIWI", "PEAR"};
+    EXPECT_EQ(expected, inorder);
+    EXPECT_EQ(4, s.size());
+}
+
+
+TEST(FrozenOrderedSet_ExtendedTests, stringsSharingLongPrefixesAreDistinguished)
+{
+    AVLSet<std::string> avl;
+
+    for (const char* word : {
+        "INTERNATIONAL", "INTERNATIONALLY", "INTERNATIONALE", "INTERNAL", "INTERN",
+        "INTERNS", "INTERNE", "INTERN\x01", "IN", "I", "", "\xff\xff"})
+    {
+        avl.add(word);
+    }
+
+    FrozenOrderedSet<std::string> s = avl.freeze();
+    ASSERT_EQ(avl.size(), s.size());
+
+    for (const std::string& word : avl)
+    {
+        EXPECT_TRUE(s.contains(word)) << word;
+        EXPECT_EQ(word, *s.lowerBound(word));
+    }
+
+    EXPECT_FALSE(s.contains("INTERNATIONALS"));
+    EXPECT_FALSE(s.contains("INTERNA"));
+    EXPECT_EQ("INTERNATIONALE", *s.upperBound("INTERNATIONAL"));
+    EXPECT_EQ("INTERNATIONAL", *s.lowerBound("INTERNAT"));
+
+    std::string_view text{"INTERNSHIP"};
+    EXPECT_TRUE(s.contains(text.substr(0, 7)));
+    EXPECT_FALSE(s.contains(text.substr(0, 8)));
+
+    std::vector<std::string> elements;
+    s.visitPrefix("INTERNATIONAL", [&](const std::string& element) { elements.push_back(element); });
+
+    std::vector<std::string> expected{"INTERNATIONAL", "INTERNATIONALE", "INTERNATIONALLY"};
+    EXPECT_EQ(expected, elements);
+}
+
+
+TEST(FrozenOrderedSet_ExtendedTests, canVisitRangesAndAddElements)
+{
+    std::vector<int> elements{10, 20, 30, 40, 50};
+    FrozenOrderedSet<int> s{elements.begin(), elements.end()};
+
+    s.add(35);
+    s.add(5);
+    s.add(60);
+    s.add(35);
+
+    EXPECT_EQ(8, s.size());
+    EXPECT_TRUE(s.contains(35));
+    EXPECT_TRUE(s.contains(5));
+
+    std::vector<int> visited;
+    s.visitRange(20, 50, [&](const int& element) { visited.push_back(element); });
+
+    std::vector<int> expected{20, 30, 35, 40};
+    EXPECT_EQ(expected, visited);
+}
@@ -3,47 +3,158 @@
 // ICS 46 Winter 2022
 // Project #4: Set the Controls for the Heart of the Sun
 //
-// A HashSet is an implementation of a Set that is a separately-chained
-// hash table, implemented as a dynamically-allocated array of linked
-// lists.  At any given time, the HashSet has a "size" indicating
-// how many elements are stored within it, along with a "capacity"
-// indicating the size of the array.
+// A HashSet is an implementation of a Set that is an open-addressed hash
+// table, laid out as three flat, dynamically-allocated arrays: an array of
+// slots holding the elements themselves, a parallel array of one-byte
+// "control bytes" recording which slots are full (see ControlGroup.hpp),
+// and a parallel array of the full hashes of the elements.
+// At any given time, the HashSet has a "size" indicating how many elements
+// are stored within it, along with a "capacity" indicating the number of
+// slots.
 //
-// As elements are added to the HashSet and the proportion of the HashSet's
-// size to its capacity exceeds 0.8 (i.e., there are more than 80% as many
-// elements as there are array cells), the HashSet should be resized so
-// that it is twice as large as it was before.
+// The slots are divided into groups of ControlGroup::WIDTH.  An element's
+// hash picks the group where its search begins (its "home"), along with a
+// seven-bit tag that is stored in its control byte.  A search compares the
+// tag against a whole group of control bytes at once, and only compares
+// hashes in slots whose tags matched, and only compares elements whose
+// whole hash matched; if the element isn't in the group
+// and the group has an empty slot, the search is over.  Otherwise, it moves
+// on to other groups in a triangular sequence (1, 2, 3, ... groups further
+// along), which visits every group when the number of groups is a power of
+// two.  Most searches touch one group of control bytes and one slot, and a
+// search for a missing element almost never touches an element at all.
+// Since every element's hash is kept, moving elements into a grown table
+// (or copying the HashSet) never calls the hash policy.
 //
-// You are not permitted to use the containers in the C++ Standard Library
-// (such as std::set, std::map, or std::vector) to store the information
-// in your data structure.  Instead, you'll need to use a dynamically-
-// allocated array and your own linked list implemenation; the linked list
-// doesn't have to be its own class, though you can do that, if you'd like.
+// The capacity is always zero or a power of two that is at least
+// ControlGroup::WIDTH.  As elements are added to the HashSet and the
+// proportion of its size to its capacity would exceed 7/8, the HashSet
+// grows so that it is twice as large as it was before.  Growth is
+// incremental: a new table is allocated, but the elements stay in the old
+// one until subsequent calls to add() move them over, MIGRATION_STEP slots
+// at a time.  In the meantime, searches look in both tables.  This way, no
+// single call to add() ever has to move every element, and the latency of
+// add() stays flat even while a large set is growing.
+//
+// Elements are hashed by a hash policy, which is a template parameter (see
+// Hashing.hpp).  By default, the policy is a FunctionHash, which wraps a
+// hash function given to the constructor, as HashSets have always been
+// configured.  A HashSet<std::string, WyHash> instead uses a built-in,
+// seeded hash that can be inlined into every search.
+//
+// A HashSet is also a BatchLookup (see BatchLookup.hpp): containsMany()
+// hashes a batch of keys and prefetches the home group of each before it
+// searches for any of them, so that the cache misses of the searches
+// overlap instead of being taken one after another.
+//
+// Elements are never removed from a Set, so the table never needs the
+// "tombstones" that open-addressed tables usually use to mark deletions.
 
 #ifndef HASHSET_HPP
 #define HASHSET_HPP
 
-#include <functional>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "BatchLookup.hpp"
+#include "ControlGroup.hpp"
+#include "Hashing.hpp"
+#include "KeyLookup.hpp"
 #include "Set.hpp"
 
 
 
-template <typename ElementType>
-class HashSet : public Set<ElementType>
+template <typename ElementType, typename Hasher = FunctionHash<ElementType>>
+class HashSet : public Set<ElementType>, public BatchLookup<BatchKey<ElementType>>
 {
 public:
-    // The default capacity of the HashSet before anything has been
-    // added to it.
-    static constexpr unsigned int DEFAULT_CAPACITY = 10;
+    // The capacity of the HashSet the first time that anything is added
+    // to it.  (An empty HashSet allocates no memory at all.)
+    static constexpr unsigned int DEFAULT_CAPACITY = ControlGroup::WIDTH;
+
+    // The number of slots of the old table that each call to add() moves
+    // into the new one while the HashSet is growing.  Since the new table
+    // is twice as large, any value of at least 2 guarantees that the move
+    // is finished before the new table needs to grow.
+    static constexpr unsigned int MIGRATION_STEP = 2 * ControlGroup::WIDTH;
+
+    // The number of keys whose home groups containsMany() prefetches before
+    // it begins searching for them.  It's large enough to keep several
+    // loads from memory in flight, but small enough that the prefetched
+    // groups are still in the cache when the searches reach them.
+    static constexpr unsigned int BATCH_SIZE = 16;
 
     // A HashFunction is a function that takes a reference to a const
     // ElementType and returns an unsigned int.
-    using HashFunction = std::function<unsigned int(const ElementType&)>;
+    using HashFunction = typename FunctionHash<ElementType>::HashFunction;
+
+    // A ProbeCounters counts the work done by searches, when probe counting
+    // is turned on.  Searches done by add() are counted along with those
+    // done by contains().
+    struct ProbeCounters
+    {
+        // The number of searches of a table.  (While the HashSet is
+        // migrating, a search may have to search both tables.)
+        unsigned long long searches;
+
+        // The number of groups of control bytes examined, in total.
+        unsigned long long groupsProbed;
+
+        // The number of elements compared against a search key, in total.
+        // Only elements whose whole hash matched the key's are compared.
+        unsigned long long comparisons;
+    };
+
+    // A Statistics is a snapshot of the shape of the table, for spotting a
+    // poor hash function or an unusual set of elements.  The probe length
+    // of an element is the number of groups that a search for it examines.
+    struct Statistics
+    {
+        unsigned int size;
+        unsigned int capacity;
+        double loadFactor;
+
+        // groupOccupancy[k] is the number of groups with k full slots.
+        unsigned int groupOccupancy[ControlGroup::WIDTH + 1];
+
+        // probeLengths[k] is the number of elements whose probe length is
+        // k + 1.
+        std::vector<unsigned int> probeLengths;
+        unsigned int maxProbeLength;
+        double meanProbeLength;
+
+        // The number of times the table has grown after its first
+        // allocation, including growth done by reserve().
+        unsigned int growthCount;
+
+        // The memory used by the HashSet and its tables.  Memory that the
+        // elements allocate themselves (e.g., long strings) isn't included.
+        std::size_t totalBytes;
+
+        ProbeCounters probes;
+    };
 
 public:
     // Initializes a HashSet to be empty, so that it will use the given
-    // hash function whenever it needs to hash an element.
-    explicit HashSet(HashFunction hashFunction);
+    // hash policy whenever it needs to hash an element (see Hashing.hpp).
+    // When the policy is FunctionHash, which it is by default, a
+    // HashFunction can be passed here instead.  Other policies can be
+    // omitted if they can be default-constructed.
+    explicit HashSet(Hasher hasher = Hasher{});
+
+    // Initializes a HashSet to contain the elements in the range [first,
+    // last), as though they were passed to bulkLoad().
+    template <
+        typename InputIterator,
+        typename = typename std::iterator_traits<InputIterator>::iterator_category>
+    HashSet(InputIterator first, InputIterator last, Hasher hasher = Hasher{});
 
     // Cleans up the HashSet so that it leaks no memory.
     ~HashSet() noexcept override;
@@ -51,8 +162,9 @@ public:
     // Initializes a new HashSet to be a copy of an existing one.
     HashSet(const HashSet& s);
 
-    // Initializes a new HashSet whose contents are moved from an
-    // expiring one.
+    // Initializes a new HashSet whose contents, including its hash
+    // policy, are moved from an expiring one.  The expiring HashSet is left
+    // empty, with a new default policy (see HashSet__defaultPolicy()).
     HashSet(HashSet&& s) noexcept;
 
     // Assigns an existing HashSet into another.
@@ -68,361 +180,948 @@ public:
 
 
     // add() adds an element to the set.  If the element is already in the set,
-    // this function has no effect.  This function triggers a resizing of the
-    // array when the ratio of size to capacity would exceed 0.8, in which case
-    // the new capacity should be determined by this formula:
+    // this function has no effect.  This function triggers a growth of the
+    // table when the ratio of size to capacity would exceed 7/8, in which case
+    // the capacity is doubled.
     //
-    //     capacity * 2 + 1
-    //
-    // In the case where the array is resized, this function runs in linear
-    // time (with respect to the number of elements, assuming a good hash
-    // function); otherwise, it runs in constant time (again, assuming a good
-    // hash function).  The amortized running time is also constant.
+    // Because the elements are moved into a grown table a few at a time, by
+    // this and subsequent calls, this function always runs in constant time
+    // (with respect to the number of elements, assuming a good hash function),
+    // aside from the cost of allocating the grown table.
     void add(const ElementType& element) override;
 
 
+    // reserve() makes the table large enough to hold the given number of
+    // elements without growing again, moving all of the elements into a
+    // larger table right away if necessary.  This function runs in linear
+    // time if the table needs to be enlarged, and constant time otherwise.
+    void reserve(unsigned int elements);
+
+
+    // bulkLoad() adds the elements in the range [first, last) to the set.
+    // When the range can be measured in advance (i.e., its iterators are
+    // forward iterators), the table is sized once, up front, so that the
+    // elements are added without any further growth or checks for it.
+    // Otherwise, the elements are added one at a time.
+    template <typename InputIterator>
+    void bulkLoad(InputIterator first, InputIterator last);
+
+
     // contains() returns true if the given element is already in the set,
     // false otherwise.  This function runs in constant time (with respect
-    // to the number of elements, assuming a good hash function).
+    // to the number of elements, assuming a good hash function).  It never
+    // modifies the HashSet, not even to move elements while it's growing.
     bool contains(const ElementType& element) const override;
 
 
+    // contains() can also be given a key of another type that can be
+    // compared to the elements directly -- for a HashSet<std::string>, a
+    // std::string_view or a string literal -- so that the caller needn't
+    // build an ElementType just to search for it.  (See KeyLookup.hpp.)
+    template <typename KeyType, typename = impl_::Set__TransparentKey<ElementType, KeyType>>
+    bool contains(const KeyType& key) const;
+
+
+    // containsMany() searches for a batch of keys at once, as described in
+    // BatchLookup.hpp.  The keys are processed BATCH_SIZE at a time: each
+    // key is hashed and its home group prefetched, and only then are the
+    // keys searched for.
+    void containsMany(const BatchKey<ElementType>* keys, std::size_t count, bool* found) const override;
+
+
     // size() returns the number of elements in the set.
     unsigned int size() const noexcept override;
 
 
-    // elementsAtIndex() returns the number of elements that hashed to a
-    // particular index in the array.  If the index is out of the boundaries
-    // of the array, this function returns 0.
+    // elementsAtIndex() returns the number of elements whose home index
+    // (the slot their hash maps to, before any probing) is the given one.
+    // If the index is out of the boundaries of the table, this function
+    // returns 0.  This function runs in linear time, with respect to the
+    // capacity, and is intended for testing.
     unsigned int elementsAtIndex(unsigned int index) const;
 
 
-    // isElementAtIndex() returns true if the given element hashed to a
-    // particular index in the array, false otherwise.  If the index is
-    // out of the boundaries of the array, this functions returns false.
+    // isElementAtIndex() returns true if the given element is in the set
+    // and its home index is the given one, false otherwise.  If the index
+    // is out of the boundaries of the table, this functions returns false.
     bool isElementAtIndex(const ElementType& element, unsigned int index) const;
 
 
-private:
-    HashFunction hashFunction;
+    // isMigrating() returns true if the HashSet has grown but not yet
+    // moved all of its elements out of the old table.
+    bool isMigrating() const noexcept;
+
+
+    // pendingMigration() returns the number of slots of the old table that
+    // have yet to be moved into the new one, or 0 if the HashSet isn't
+    // migrating.
+    unsigned int pendingMigration() const noexcept;
+
+
+    // statistics() measures the table.  This function runs in linear time,
+    // with respect to the capacity.  While the HashSet is migrating, the
+    // capacity and occupancy are those of the new table, but the probe
+    // lengths of elements still in the old table are included.
+    Statistics statistics() const;
+
+
+    // setProbeCounting() turns the counting of probes by searches on or off.
+    // It's off by default, since it makes searches (slightly) slower and
+    // makes contains() write to the HashSet, so a HashSet that counts probes
+    // must not be searched by multiple threads at once.
+    void setProbeCounting(bool enabled) noexcept;
 
-    // You'll no doubt want to add member variables and "helper" member
-    // functions here.
-    
-    struct Node
+
+    // resetProbeCounters() sets the probe counters back to zero.
+    void resetProbeCounters() noexcept;
+
+
+private:
+    Hasher hasher;
+
+    // A Table is one array of control bytes and its parallel arrays of
+    // slots and hashes; control[i] is the control byte for slots[i], and
+    // hashes[i] is the hash of the element in it.  A table with no slots
+    // has control pointing to ControlGroup::emptyGroup() and slots and
+    // hashes set to null.
+    struct Table
     {
-        ElementType key;
-        ElementType value;
-        Node* next;
+        std::int8_t* control;
+        ElementType* slots;
+        std::uint64_t* hashes;
+        unsigned int capacity;
     };
 
-    Node **bucket;
-    unsigned int bucketSize;
-    unsigned int cap;
+    // New elements are always added to "table".  While migrating, the
+    // slots of "oldTable" below "migrated" have already been moved (and
+    // their elements destroyed), while the rest are still to be moved.
+    // Their control bytes are left as they were, so that searches in the
+    // old table can still probe past them.
+    Table table;
+    Table oldTable;
+    unsigned int migrated;
+    unsigned int count;
+
+    unsigned int growthCount;
+    bool countingProbes;
+    mutable ProbeCounters probeCounters;
+
+private:
+    std::uint64_t hashOf(const ElementType& element) const;
+
+    template <typename KeyType>
+    std::uint64_t hashOfKey(const KeyType& key) const;
+
+    template <typename KeyType>
+    bool findSlot(
+        const Table& t, unsigned int firstLiveSlot, const KeyType& key,
+        std::uint64_t hash, unsigned int& slot) const;
+
+    template <typename KeyType>
+    bool findAnywhere(const KeyType& key, std::uint64_t hash) const;
+
+    void grow();
+    void beginMigration(unsigned int newCapacity);
+    void migrate(unsigned int slotsToMove);
+    void measureTable(const Table& t, unsigned int firstLiveSlot, Statistics& statistics) const;
+    void recordProbes(unsigned int groups, unsigned int comparisons) const noexcept;
+
+    static Table emptyTable() noexcept;
+    static Table allocateTable(unsigned int capacity);
+    static void releaseTable(Table& t, unsigned int firstLiveSlot) noexcept;
+    static void occupy(Table& t, unsigned int slot, std::uint64_t hash) noexcept;
+    static unsigned int groupMask(const Table& t) noexcept;
+    static void prefetchHome(const Table& t, std::uint64_t hash) noexcept;
+    static unsigned int findEmptySlot(const Table& t, std::uint64_t hash) noexcept;
 };
 
 
 
 namespace impl_
 {
+    // The low seven bits of a hash are the tag stored in the control byte
+    // of the element's slot; the bits above them determine its home.
+    inline std::int8_t HashSet__tag(std::uint64_t hash) noexcept
+    {
+        return static_cast<std::int8_t>(hash & 0x7F);
+    }
+
+
+    inline unsigned int HashSet__homeIndex(std::uint64_t hash, unsigned int capacity) noexcept
+    {
+        return static_cast<unsigned int>(hash >> 7) & (capacity - 1);
+    }
+
+
+    inline unsigned int HashSet__homeGroup(std::uint64_t hash, unsigned int groupMask) noexcept
+    {
+        return static_cast<unsigned int>(hash >> 11) & groupMask;
+    }
+
+
+    // The most elements that a table with the given capacity may hold
+    // before it has to grow.
+    inline unsigned int HashSet__maxLoad(unsigned int capacity) noexcept
+    {
+        return capacity - capacity / 8;
+    }
+
+
+    // The smallest capacity that can hold the given number of elements.
+    inline unsigned int HashSet__capacityFor(unsigned int elements) noexcept
+    {
+        unsigned int capacity = ControlGroup::WIDTH;
+
+        while (HashSet__maxLoad(capacity) < elements)
+        {
+            capacity *= 2;
+        }
+
+        return capacity;
+    }
+
+
     template <typename ElementType>
-    unsigned int HashSet__undefinedHashFunction(const ElementType& element)
+    unsigned int HashSet__undefinedHashFunction(const ElementType&)
     {
         return 0;
     }
-}
 
 
-template <typename ElementType>
-HashSet<ElementType>::HashSet(HashFunction hashFunction)
-    : hashFunction{hashFunction}, bucket{new Node*[DEFAULT_CAPACITY]}, bucketSize{0}, cap{DEFAULT_CAPACITY}
-{
-    for(unsigned int i = 0; i < DEFAULT_CAPACITY; ++i)
+    // HashSet__defaultPolicy() returns the hash policy that a HashSet is
+    // left with after it's been moved from: a default-constructed one, or,
+    // for a FunctionHash (which has no default), one wrapping
+    // HashSet__undefinedHashFunction(), so that the HashSet can still be
+    // used, though it hashes everything alike.
+    template <typename ElementType, typename Hasher>
+    Hasher HashSet__defaultPolicy()
     {
-        bucket[i] = nullptr;
+        if constexpr (std::is_default_constructible_v<Hasher>)
+        {
+            return Hasher{};
+        }
+        else
+        {
+            return Hasher{HashSet__undefinedHashFunction<ElementType>};
+        }
     }
 }
 
 
-template <typename ElementType>
-HashSet<ElementType>::~HashSet() noexcept
+template <typename ElementType, typename Hasher>
+HashSet<ElementType, Hasher>::HashSet(Hasher hasher)
+    : hasher{std::move(hasher)},
+      table{emptyTable()}, oldTable{emptyTable()}, migrated{0}, count{0},
+      growthCount{0}, countingProbes{false}, probeCounters{0, 0, 0}
+{
+}
+
+
+template <typename ElementType, typename Hasher>
+template <typename InputIterator, typename>
+HashSet<ElementType, Hasher>::HashSet(InputIterator first, InputIterator last, Hasher hasher)
+    : HashSet{std::move(hasher)}
+{
+    bulkLoad(first, last);
+}
+
+
+template <typename ElementType, typename Hasher>
+HashSet<ElementType, Hasher>::~HashSet() noexcept
 {
-    for(unsigned int i = 0; i < DEFAULT_CAPACITY; i++)
+    releaseTable(table, 0);
+    releaseTable(oldTable, migrated);
+}
+
+
+template <typename ElementType, typename Hasher>
+HashSet<ElementType, Hasher>::HashSet(const HashSet& s)
+    : hasher{s.hasher},
+      table{emptyTable()}, oldTable{emptyTable()}, migrated{0}, count{0},
+      growthCount{0}, countingProbes{false}, probeCounters{0, 0, 0}
+{
+    if (s.table.capacity == 0)
     {
-        Node* newNode = bucket[i];
-        while(newNode != nullptr)
+        return;
+    }
+
+    // The copy doesn't inherit the migration; instead, its elements all
+    // go into one table, which is already large enough to hold them.
+    table = allocateTable(s.table.capacity);
+
+    try
+    {
+        for (unsigned int i = 0; i < table.capacity; ++i)
         {
-            Node* temp = newNode;
-            newNode = newNode->next; 
-            delete temp;
+            if (s.table.control[i] != ControlGroup::EMPTY)
+            {
+                new (table.slots + i) ElementType(s.table.slots[i]);
+                occupy(table, i, s.table.hashes[i]);
+                ++count;
+            }
+        }
+
+        for (unsigned int i = s.migrated; i < s.oldTable.capacity; ++i)
+        {
+            if (s.oldTable.control[i] != ControlGroup::EMPTY)
+            {
+                std::uint64_t hash = s.oldTable.hashes[i];
+                unsigned int slot = findEmptySlot(table, hash);
+
+                new (table.slots + slot) ElementType(s.oldTable.slots[i]);
+                occupy(table, slot, hash);
+                ++count;
+            }
         }
     }
-    delete[] bucket;
+    catch (...)
+    {
+        releaseTable(table, 0);
+        throw;
+    }
+}
+
+
+template <typename ElementType, typename Hasher>
+HashSet<ElementType, Hasher>::HashSet(HashSet&& s) noexcept
+    : hasher{std::move(s.hasher)},
+      table{emptyTable()}, oldTable{emptyTable()}, migrated{0}, count{0},
+      growthCount{0}, countingProbes{false}, probeCounters{0, 0, 0}
+{
+    s.hasher = impl_::HashSet__defaultPolicy<ElementType, Hasher>();
+
+    std::swap(table, s.table);
+    std::swap(oldTable, s.oldTable);
+    std::swap(migrated, s.migrated);
+    std::swap(count, s.count);
+    std::swap(growthCount, s.growthCount);
+    std::swap(countingProbes, s.countingProbes);
+    std::swap(probeCounters, s.probeCounters);
 }
 
 
-template <typename ElementType>
-HashSet<ElementType>::HashSet(const HashSet& s)
-    : hashFunction{impl_::HashSet__undefinedHashFunction<ElementType>}
+template <typename ElementType, typename Hasher>
+HashSet<ElementType, Hasher>& HashSet<ElementType, Hasher>::operator=(const HashSet& s)
 {
-    bucketSize = s.bucketSize;
-    cap = s.cap;
-    bucket = new Node*[cap];
-    
-    for(unsigned int i = 0; i < cap; ++i)
+    if (this != &s)
     {
-        bucket[i] = nullptr;
+        HashSet copy{s};
+        *this = std::move(copy);
     }
 
-    for(unsigned int i = 0; i < cap; ++i)
+    return *this;
+}
+
+
+template <typename ElementType, typename Hasher>
+HashSet<ElementType, Hasher>& HashSet<ElementType, Hasher>::operator=(HashSet&& s) noexcept
+{
+    // The expiring HashSet is left as the move constructor leaves one, and
+    // this one's old elements are destroyed along with moved.
+    HashSet moved{std::move(s)};
+
+    std::swap(hasher, moved.hasher);
+    std::swap(table, moved.table);
+    std::swap(oldTable, moved.oldTable);
+    std::swap(migrated, moved.migrated);
+    std::swap(count, moved.count);
+    std::swap(growthCount, moved.growthCount);
+    std::swap(countingProbes, moved.countingProbes);
+    std::swap(probeCounters, moved.probeCounters);
+
+    return *this;
+}
+
+
+template <typename ElementType, typename Hasher>
+bool HashSet<ElementType, Hasher>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename ElementType, typename Hasher>
+void HashSet<ElementType, Hasher>::add(const ElementType& element)
+{
+    if (isMigrating())
     {
-        Node* newNode = s.bucket[i];
+        migrate(MIGRATION_STEP);
+    }
 
-        while(newNode != nullptr)
-        {
-            bucket[i]->key = s.bucket[i]->key;
-            bucket[i]->value = s.bucket[i]->value;
-            bucket[i]->next = s.bucket[i]->next;
+    std::uint64_t hash = hashOf(element);
+    unsigned int slot;
 
-            newNode = newNode->next;
-        }
+    if (findSlot(table, 0, element, hash, slot))
+    {
+        return;
+    }
+
+    unsigned int oldSlot;
+
+    if (isMigrating() && findSlot(oldTable, migrated, element, hash, oldSlot))
+    {
+        return;
     }
+
+    if (count + 1 > impl_::HashSet__maxLoad(table.capacity))
+    {
+        grow();
+        slot = findEmptySlot(table, hash);
+    }
+
+    new (table.slots + slot) ElementType(element);
+    occupy(table, slot, hash);
+    ++count;
 }
 
 
-template <typename ElementType>
-HashSet<ElementType>::HashSet(HashSet&& s) noexcept
-    : hashFunction{impl_::HashSet__undefinedHashFunction<ElementType>}
+template <typename ElementType, typename Hasher>
+void HashSet<ElementType, Hasher>::reserve(unsigned int elements)
 {
-    bucketSize = 0;
-    cap = DEFAULT_CAPACITY;
-    bucket = new Node*[cap];
-
-    for(unsigned int i = 0; i < cap; ++i)
+    if (elements <= impl_::HashSet__maxLoad(table.capacity))
     {
-        bucket[i] = nullptr;
+        return;
     }
-    
-    std::swap(bucketSize, s.bucketSize);
-    std::swap(cap, s.cap);
-    std::swap(bucket, s.bucket);
+
+    beginMigration(impl_::HashSet__capacityFor(elements));
+    migrate(pendingMigration());
 }
 
 
-template <typename ElementType>
-HashSet<ElementType>& HashSet<ElementType>::operator=(const HashSet& s)
+template <typename ElementType, typename Hasher>
+template <typename InputIterator>
+void HashSet<ElementType, Hasher>::bulkLoad(InputIterator first, InputIterator last)
 {
-    if(this != &s)
+    using Category = typename std::iterator_traits<InputIterator>::iterator_category;
+
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, Category>)
     {
-        bucketSize = s.bucketSize;
-        cap = s.cap;
-        
-        for(unsigned int i = 0; i < cap; ++i)
+        reserve(count + static_cast<unsigned int>(std::distance(first, last)));
+
+        if (isMigrating())
         {
-            bucket[i] = nullptr;
+            migrate(pendingMigration());
         }
 
-        for(unsigned int j = 0; j < cap; ++j)
+        // Now that every element will fit into the table, and every element
+        // is in the table, there's no need to check for growth or to look
+        // in the old table.
+        for (; first != last; ++first)
         {
-            Node* newNode = s.bucket[j];
+            const ElementType& element = *first;
+            std::uint64_t hash = hashOf(element);
+            unsigned int slot;
 
-            while(newNode != nullptr)
+            if (!findSlot(table, 0, element, hash, slot))
             {
-                bucket[j] = newNode;
-                newNode = newNode->next;
+                new (table.slots + slot) ElementType(element);
+                occupy(table, slot, hash);
+                ++count;
             }
-            delete newNode;
         }
     }
-    return *this;
+    else
+    {
+        for (; first != last; ++first)
+        {
+            add(*first);
+        }
+    }
 }
 
 
-template <typename ElementType>
-HashSet<ElementType>& HashSet<ElementType>::operator=(HashSet&& s) noexcept
+template <typename ElementType, typename Hasher>
+bool HashSet<ElementType, Hasher>::contains(const ElementType& element) const
 {
-    std::swap(bucketSize, s.bucketSize);
-    std::swap(cap, s.cap);
-    std::swap(bucket, s.bucket);
-    
-    return *this;
+    return findAnywhere(element, hashOf(element));
 }
 
 
-template <typename ElementType>
-bool HashSet<ElementType>::isImplemented() const noexcept
+template <typename ElementType, typename Hasher>
+template <typename KeyType, typename>
+bool HashSet<ElementType, Hasher>::contains(const KeyType& key) const
 {
-    return true;
+    std::string_view view{key};
+
+    return findAnywhere(view, hashOfKey(view));
 }
 
 
-template <typename ElementType>
-void HashSet<ElementType>::add(const ElementType& element)
+template <typename ElementType, typename Hasher>
+void HashSet<ElementType, Hasher>::containsMany(
+    const BatchKey<ElementType>* keys, std::size_t count, bool* found) const
 {
-    unsigned int hashKey = hashFunction(element) % cap;
-    Node* temp = nullptr;
-    Node* newNode;
-    newNode = bucket[hashKey];
-    
-    while(newNode != nullptr)
+    std::uint64_t hashes[BATCH_SIZE];
+
+    for (std::size_t first = 0; first < count; first += BATCH_SIZE)
     {
-        temp = newNode;
-        newNode = newNode->next;
+        std::size_t batchSize = count - first < BATCH_SIZE ? count - first : BATCH_SIZE;
+
+        for (std::size_t i = 0; i < batchSize; ++i)
+        {
+            hashes[i] = hashOfKey(keys[first + i]);
+            prefetchHome(table, hashes[i]);
+
+            if (isMigrating())
+            {
+                prefetchHome(oldTable, hashes[i]);
+            }
+        }
+
+        for (std::size_t i = 0; i < batchSize; ++i)
+        {
+            found[first + i] = findAnywhere(keys[first + i], hashes[i]);
+        }
+    }
+}
+
+
+template <typename ElementType, typename Hasher>
+unsigned int HashSet<ElementType, Hasher>::size() const noexcept
+{
+    return count;
+}
+
+
+template <typename ElementType, typename Hasher>
+unsigned int HashSet<ElementType, Hasher>::elementsAtIndex(unsigned int index) const
+{
+    if (index >= table.capacity)
+    {
+        return 0;
     }
-    if(newNode == nullptr)
+
+    unsigned int total = 0;
+
+    for (unsigned int i = 0; i < table.capacity; ++i)
     {
-        newNode = new Node;
-        newNode->key = hashKey;
-        newNode->value = element;
-        newNode->next = nullptr;
-        
-        if(temp == nullptr)
+        if (table.control[i] != ControlGroup::EMPTY
+            && impl_::HashSet__homeIndex(table.hashes[i], table.capacity) == index)
         {
-            bucket[hashKey] = newNode;
+            ++total;
         }
-        else
+    }
+
+    for (unsigned int i = migrated; i < oldTable.capacity; ++i)
+    {
+        if (oldTable.control[i] != ControlGroup::EMPTY
+            && impl_::HashSet__homeIndex(oldTable.hashes[i], table.capacity) == index)
         {
-            temp->next = newNode;
+            ++total;
         }
     }
-    else
+
+    return total;
+}
+
+
+template <typename ElementType, typename Hasher>
+bool HashSet<ElementType, Hasher>::isElementAtIndex(const ElementType& element, unsigned int index) const
+{
+    if (index >= table.capacity)
     {
-        newNode->value = element;
+        return false;
     }
 
-    if(bucketSize > (0.8 * cap))
+    std::uint64_t hash = hashOf(element);
+
+    return impl_::HashSet__homeIndex(hash, table.capacity) == index
+        && findAnywhere(element, hash);
+}
+
+
+template <typename ElementType, typename Hasher>
+bool HashSet<ElementType, Hasher>::isMigrating() const noexcept
+{
+    return oldTable.capacity != 0;
+}
+
+
+template <typename ElementType, typename Hasher>
+unsigned int HashSet<ElementType, Hasher>::pendingMigration() const noexcept
+{
+    return oldTable.capacity - migrated;
+}
+
+
+template <typename ElementType, typename Hasher>
+typename HashSet<ElementType, Hasher>::Statistics HashSet<ElementType, Hasher>::statistics() const
+{
+    Statistics statistics{};
+
+    statistics.size = count;
+    statistics.capacity = table.capacity;
+    statistics.loadFactor = table.capacity == 0 ? 0.0 : static_cast<double>(count) / table.capacity;
+    statistics.maxProbeLength = 0;
+    statistics.growthCount = growthCount;
+    statistics.totalBytes =
+        sizeof(*this)
+        + static_cast<std::size_t>(table.capacity + oldTable.capacity) * (1 + sizeof(ElementType) + sizeof(std::uint64_t));
+    statistics.probes = probeCounters;
+
+    for (unsigned int group = 0; group * ControlGroup::WIDTH < table.capacity; ++group)
     {
-        int newCap = cap*2 + 1;
-        Node** newBucket = new Node*[newCap];
+        ControlGroup::BitMask empty = ControlGroup{table.control + group * ControlGroup::WIDTH}.matchEmpty();
+        unsigned int full = ControlGroup::WIDTH;
 
-        for(unsigned int i = 0; i < newCap; ++i)
+        for (; empty != 0; empty &= empty - 1)
         {
-            newBucket[i] = nullptr;
+            --full;
         }
-        
-        int newHashKey;
-        for(unsigned int j = 0; j < newCap; ++j)
-        {
-            newHashKey = hashFunction(element) % newCap;
-            Node* temp2 = nullptr;
-            Node* newNode2;
-            newNode2 = newBucket[newHashKey];
 
-            while(temp2 != nullptr)
-            {
-                temp2 = newNode2;
-                newNode2 = newNode2->next;
-            }
-            if(newNode2 == nullptr)
-            {
-                newNode2 = new Node;
-                newNode2->key = newHashKey;
-                newNode2->value = element;
-                newNode2->next = nullptr;
+        ++statistics.groupOccupancy[full];
+    }
 
-                if(temp2 == nullptr)
-                {
-                    newBucket[newHashKey] = newNode2;
-                }
-                else
-                {
-                    temp2->next = newNode2;
-                }
-            }
-            else
-            {
-                newNode2->value = element;
-            }
-            
-        }
-        delete [] bucket;
-        bucket = newBucket;
-        cap = newCap;
+    measureTable(table, 0, statistics);
+    measureTable(oldTable, migrated, statistics);
+
+    unsigned long long totalProbeLength = 0;
+
+    for (unsigned int i = 0; i < statistics.probeLengths.size(); ++i)
+    {
+        totalProbeLength += static_cast<unsigned long long>(i + 1) * statistics.probeLengths[i];
     }
-    bucketSize++;
+
+    statistics.meanProbeLength = count == 0 ? 0.0 : static_cast<double>(totalProbeLength) / count;
+
+    return statistics;
+}
+
+
+template <typename ElementType, typename Hasher>
+void HashSet<ElementType, Hasher>::setProbeCounting(bool enabled) noexcept
+{
+    countingProbes = enabled;
 }
 
 
-template <typename ElementType>
-bool HashSet<ElementType>::contains(const ElementType& element) const
+template <typename ElementType, typename Hasher>
+void HashSet<ElementType, Hasher>::resetProbeCounters() noexcept
 {
-    unsigned int hashKey = hashFunction(element) % cap;
-    Node* newNode = bucket[hashKey];
+    probeCounters = ProbeCounters{0, 0, 0};
+}
+
+
+template <typename ElementType, typename Hasher>
+std::uint64_t HashSet<ElementType, Hasher>::hashOf(const ElementType& element) const
+{
+    return hasher(element);
+}
+
 
-    while(newNode != nullptr)
+// hashOfKey() hashes a key that may be a std::string_view rather than an
+// ElementType.  It hashes such keys directly if the hash policy accepts
+// them; otherwise, the key is copied into a per-thread buffer that's reused
+// from one call to the next, so that once the buffer has grown to fit the
+// longest key, this never allocates.
+template <typename ElementType, typename Hasher>
+template <typename KeyType>
+std::uint64_t HashSet<ElementType, Hasher>::hashOfKey(const KeyType& key) const
+{
+    if constexpr (std::is_same_v<KeyType, ElementType>)
+    {
+        return hashOf(key);
+    }
+    else if constexpr (std::is_invocable_v<const Hasher&, const KeyType&>)
+    {
+        return hasher(key);
+    }
+    else
     {
-        if(newNode->value == element)
+        thread_local ElementType buffer;
+        buffer.assign(key.data(), key.size());
+
+        return hashOf(buffer);
+    }
+}
+
+
+// findSlot() searches the given table for the given key, whose hash has
+// already been determined, ignoring any slots below firstLiveSlot.  If
+// an element equal to it is found, its slot is stored into "slot" and true is returned;
+// otherwise, the empty slot where it belongs is stored into "slot" and
+// false is returned.  (When the table has no slots, there is no such
+// slot, but the table must grow before anything is added to it, anyway.)
+template <typename ElementType, typename Hasher>
+template <typename KeyType>
+bool HashSet<ElementType, Hasher>::findSlot(
+    const Table& t, unsigned int firstLiveSlot, const KeyType& key,
+    std::uint64_t hash, unsigned int& slot) const
+{
+    const std::int8_t tag = impl_::HashSet__tag(hash);
+    const unsigned int mask = groupMask(t);
+    unsigned int group = impl_::HashSet__homeGroup(hash, mask);
+
+    unsigned int comparisons = 0;
+
+    for (unsigned int step = 1; ; ++step)
+    {
+        const unsigned int base = group * ControlGroup::WIDTH;
+        ControlGroup controlGroup{t.control + base};
+
+        for (ControlGroup::BitMask matches = controlGroup.match(tag); matches != 0; matches &= matches - 1)
         {
-            return true;
+            unsigned int candidate = base + ControlGroup::lowestBit(matches);
+
+            if (candidate >= firstLiveSlot && t.hashes[candidate] == hash)
+            {
+                ++comparisons;
+
+                if (t.slots[candidate] == key)
+                {
+                    recordProbes(step, comparisons);
+                    slot = candidate;
+                    return true;
+                }
+            }
         }
-        else
+
+        ControlGroup::BitMask empty = controlGroup.matchEmpty();
+
+        if (empty != 0)
         {
-            newNode = newNode->next;
+            recordProbes(step, comparisons);
+            slot = base + ControlGroup::lowestBit(empty);
+            return false;
         }
+
+        group = (group + step) & mask;
     }
-    return false;
+}
+
+
+// findAnywhere() returns true if the given key, whose hash has already
+// been determined, is in either table.
+template <typename ElementType, typename Hasher>
+template <typename KeyType>
+bool HashSet<ElementType, Hasher>::findAnywhere(const KeyType& key, std::uint64_t hash) const
+{
+    unsigned int slot;
 
+    return findSlot(table, 0, key, hash, slot)
+        || (isMigrating() && findSlot(oldTable, migrated, key, hash, slot));
 }
 
 
-template <typename ElementType>
-unsigned int HashSet<ElementType>::size() const noexcept
+// grow() begins migrating into a table twice as large as the current one.
+template <typename ElementType, typename Hasher>
+void HashSet<ElementType, Hasher>::grow()
 {
-    return bucketSize;
+    beginMigration(table.capacity == 0 ? DEFAULT_CAPACITY : table.capacity * 2);
 }
 
 
-template <typename ElementType>
-unsigned int HashSet<ElementType>::elementsAtIndex(unsigned int index) const
+// beginMigration() allocates a new table with the given capacity, which
+// must be large enough to hold every element, and makes the current table
+// the old one.  If the previous migration is somehow still in progress,
+// it's finished first, so that there are never more than two tables.
+template <typename ElementType, typename Hasher>
+void HashSet<ElementType, Hasher>::beginMigration(unsigned int newCapacity)
 {
-    unsigned int total = 0;
-    
-    if(index >= cap && index < 0)
+    if (isMigrating())
     {
-        return 0;
+        migrate(pendingMigration());
     }
-    else
+
+    Table newTable = allocateTable(newCapacity);
+
+    if (table.capacity == 0)
     {
-        Node* newNode;
-        newNode = bucket[index];
+        table = newTable;
+        return;
+    }
+
+    ++growthCount;
+    oldTable = table;
+    table = newTable;
+    migrated = 0;
+}
+
+
+// migrate() moves the elements in (up to) the given number of slots of
+// the old table into the new one, releasing the old table once all of its
+// slots have been moved.
+template <typename ElementType, typename Hasher>
+void HashSet<ElementType, Hasher>::migrate(unsigned int slotsToMove)
+{
+    unsigned int end = migrated + slotsToMove;
 
-        while(newNode != nullptr)
+    if (end > oldTable.capacity)
+    {
+        end = oldTable.capacity;
+    }
+
+    for (; migrated < end; ++migrated)
+    {
+        if (oldTable.control[migrated] != ControlGroup::EMPTY)
         {
-            newNode = newNode->next;
-            total++;
+            ElementType& element = oldTable.slots[migrated];
+            std::uint64_t hash = oldTable.hashes[migrated];
+            unsigned int slot = findEmptySlot(table, hash);
+
+            new (table.slots + slot) ElementType(std::move(element));
+            occupy(table, slot, hash);
+
+            element.~ElementType();
         }
-        delete newNode;;
     }
-    return total;
+
+    if (migrated == oldTable.capacity)
+    {
+        releaseTable(oldTable, migrated);
+        migrated = 0;
+    }
 }
 
 
-template <typename ElementType>
-bool HashSet<ElementType>::isElementAtIndex(const ElementType& element, unsigned int index) const
+// measureTable() adds the probe lengths of the elements in the given table's
+// slots, from firstLiveSlot onward, to the given statistics.  An element's
+// probe length is found by following its probe sequence from its home
+// group until reaching the group where it lives.
+template <typename ElementType, typename Hasher>
+void HashSet<ElementType, Hasher>::measureTable(
+    const Table& t, unsigned int firstLiveSlot, Statistics& statistics) const
 {
-    if(index >= cap && index < 0)
+    const unsigned int mask = groupMask(t);
+
+    for (unsigned int i = firstLiveSlot; i < t.capacity; ++i)
     {
-        return false;
+        if (t.control[i] == ControlGroup::EMPTY)
+        {
+            continue;
+        }
+
+        unsigned int group = impl_::HashSet__homeGroup(t.hashes[i], mask);
+        unsigned int probeLength = 1;
+
+        for (; group != i / ControlGroup::WIDTH; ++probeLength)
+        {
+            group = (group + probeLength) & mask;
+        }
+
+        if (statistics.probeLengths.size() < probeLength)
+        {
+            statistics.probeLengths.resize(probeLength, 0);
+        }
+
+        ++statistics.probeLengths[probeLength - 1];
+
+        if (probeLength > statistics.maxProbeLength)
+        {
+            statistics.maxProbeLength = probeLength;
+        }
     }
-    else
+}
+
+
+template <typename ElementType, typename Hasher>
+void HashSet<ElementType, Hasher>::recordProbes(unsigned int groups, unsigned int comparisons) const noexcept
+{
+    if (countingProbes)
     {
-        Node* newNode;
-        newNode = bucket[index];
+        ++probeCounters.searches;
+        probeCounters.groupsProbed += groups;
+        probeCounters.comparisons += comparisons;
+    }
+}
+
+
+template <typename ElementType, typename Hasher>
+typename HashSet<ElementType, Hasher>::Table HashSet<ElementType, Hasher>::emptyTable() noexcept
+{
+    // The empty group is never written, because a table with no slots
+    // always grows before anything is added to it.
+    return Table{const_cast<std::int8_t*>(ControlGroup::emptyGroup()), nullptr, nullptr, 0};
+}
 
-        while(newNode != nullptr)
+
+template <typename ElementType, typename Hasher>
+typename HashSet<ElementType, Hasher>::Table HashSet<ElementType, Hasher>::allocateTable(unsigned int capacity)
+{
+    std::unique_ptr<std::int8_t[]> control{new std::int8_t[capacity]};
+    std::unique_ptr<std::uint64_t[]> hashes{new std::uint64_t[capacity]};
+    ElementType* slots = std::allocator<ElementType>{}.allocate(capacity);
+
+    std::memset(control.get(), ControlGroup::EMPTY, capacity);
+
+    return Table{control.release(), slots, hashes.release(), capacity};
+}
+
+
+// releaseTable() destroys the elements in the given table's slots from
+// firstLiveSlot onward, then releases the table, leaving it with no slots.
+template <typename ElementType, typename Hasher>
+void HashSet<ElementType, Hasher>::releaseTable(Table& t, unsigned int firstLiveSlot) noexcept
+{
+    if (t.capacity != 0)
+    {
+        for (unsigned int i = firstLiveSlot; i < t.capacity; ++i)
         {
-            if(newNode->value == element)
+            if (t.control[i] != ControlGroup::EMPTY)
             {
-                return true;
+                t.slots[i].~ElementType();
             }
-            newNode = newNode->next;
         }
-        delete newNode;
+
+        delete[] t.control;
+        delete[] t.hashes;
+        std::allocator<ElementType>{}.deallocate(t.slots, t.capacity);
     }
-    return false;
+
+    t = emptyTable();
 }
 
 
+template <typename ElementType, typename Hasher>
+unsigned int HashSet<ElementType, Hasher>::groupMask(const Table& t) noexcept
+{
+    return t.capacity == 0 ? 0 : t.capacity / ControlGroup::WIDTH - 1;
+}
 
-#endif
 
+// occupy() records that the given slot of the given table now holds an
+// element with the given hash.
+template <typename ElementType, typename Hasher>
+void HashSet<ElementType, Hasher>::occupy(Table& t, unsigned int slot, std::uint64_t hash) noexcept
+{
+    t.control[slot] = impl_::HashSet__tag(hash);
+    t.hashes[slot] = hash;
+}
+
+
+// prefetchHome() prefetches the control bytes of the home group of the
+// given hash in the given table.
+template <typename ElementType, typename Hasher>
+void HashSet<ElementType, Hasher>::prefetchHome(const Table& t, std::uint64_t hash) noexcept
+{
+    unsigned int group = impl_::HashSet__homeGroup(hash, groupMask(t));
+    ControlGroup::prefetch(t.control + group * ControlGroup::WIDTH);
+}
+
+
+// findEmptySlot() returns the slot where an element with the given hash,
+// which is known not to be in the given table, belongs.  The table must
+// have at least one empty slot.
+template <typename ElementType, typename Hasher>
+unsigned int HashSet<ElementType, Hasher>::findEmptySlot(const Table& t, std::uint64_t hash) noexcept
+{
+    const unsigned int mask = groupMask(t);
+    unsigned int group = impl_::HashSet__homeGroup(hash, mask);
+
+    for (unsigned int step = 1; ; ++step)
+    {
+        const unsigned int base = group * ControlGroup::WIDTH;
+        ControlGroup::BitMask empty = ControlGroup{t.control + base}.matchEmpty();
+
+        if (empty != 0)
+        {
+            return base + ControlGroup::lowestBit(empty);
+        }
+
+        group = (group + step) & mask;
+    }
+}
+
+
+
+#endif
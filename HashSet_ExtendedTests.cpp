@@ -0,0 +1,525 @@
+// HashSet_ExtendedTests.cpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// These unit tests go beyond the sanity-checking tests, exercising the
+// parts of the HashSet implementation that the sanity-checking tests
+// don't reach: probing past a full group, resizing, and copying.
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <gtest/gtest.h>
+#include "HashSet.hpp"
+
+
+namespace
+{
+    template <typename T>
+    unsigned int zeroHash(const T&)
+    {
+        return 0;
+    }
+
+
+    unsigned int identityHash(const int& i)
+    {
+        return static_cast<unsigned int>(i);
+    }
+
+
+    unsigned int lengthHash(const std::string& s)
+    {
+        return static_cast<unsigned int>(s.length());
+    }
+
+
+    // A hash policy whose hashes differ only above their tags.
+    struct SameTagHash
+    {
+        std::uint64_t operator()(const int& i) const
+        {
+            return static_cast<std::uint64_t>(i) << 16;
+        }
+    };
+}
+
+
+TEST(HashSet_ExtendedTests, canProbePastFullGroupsWhenAllElementsCollide)
+{
+    HashSet<int> s{zeroHash<int>};
+
+    for (int i = 0; i < 100; ++i)
+    {
+        s.add(i);
+    }
+
+    EXPECT_EQ(100, s.size());
+    EXPECT_EQ(100, s.elementsAtIndex(0));
+
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_TRUE(s.contains(i));
+        EXPECT_TRUE(s.isElementAtIndex(i, 0));
+    }
+
+    EXPECT_FALSE(s.contains(100));
+    EXPECT_FALSE(s.contains(-1));
+}
+
+
+TEST(HashSet_ExtendedTests, addingDuplicatesHasNoEffect)
+{
+    HashSet<int> s{identityHash};
+
+    for (int round = 0; round < 3; ++round)
+    {
+        for (int i = 0; i < 50; ++i)
+        {
+            s.add(i);
+        }
+    }
+
+    EXPECT_EQ(50, s.size());
+}
+
+
+TEST(HashSet_ExtendedTests, containsEverythingAfterManyResizes)
+{
+    HashSet<int> s{identityHash};
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        s.add(i * 7);
+    }
+
+    EXPECT_EQ(20000, s.size());
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        EXPECT_TRUE(s.contains(i * 7));
+        EXPECT_FALSE(s.contains(i * 7 + 1));
+    }
+}
+
+
+TEST(HashSet_ExtendedTests, emptySetContainsNothing)
+{
+    HashSet<std::string> s{lengthHash};
+
+    EXPECT_EQ(0, s.size());
+    EXPECT_FALSE(s.contains(""));
+    EXPECT_FALSE(s.contains("BOO"));
+    EXPECT_EQ(0, s.elementsAtIndex(0));
+}
+
+
+TEST(HashSet_ExtendedTests, copiesAreIndependent)
+{
+    HashSet<std::string> s1{lengthHash};
+    s1.add("HELLO");
+    s1.add("THERE");
+    s1.add("BOO");
+
+    HashSet<std::string> s2{s1};
+    s2.add("PERSON");
+
+    EXPECT_EQ(3, s1.size());
+    EXPECT_EQ(4, s2.size());
+    EXPECT_TRUE(s2.contains("HELLO"));
+    EXPECT_TRUE(s2.contains("BOO"));
+    EXPECT_FALSE(s1.contains("PERSON"));
+
+    HashSet<std::string> s3{lengthHash};
+    s3 = s2;
+    EXPECT_EQ(4, s3.size());
+    EXPECT_TRUE(s3.contains("PERSON"));
+}
+
+
+TEST(HashSet_ExtendedTests, movedFromSetIsEmptyAndUsable)
+{
+    HashSet<std::string> s1{lengthHash};
+    s1.add("HELLO");
+    s1.add("THERE");
+
+    HashSet<std::string> s2{std::move(s1)};
+    EXPECT_EQ(2, s2.size());
+    EXPECT_TRUE(s2.contains("THERE"));
+
+    EXPECT_EQ(0, s1.size());
+    EXPECT_FALSE(s1.contains("HELLO"));
+    s1.add("BOO");
+    EXPECT_TRUE(s1.contains("BOO"));
+
+    HashSet<std::string> s3{lengthHash};
+    s3.add("PERSON");
+    s3 = std::move(s2);
+    EXPECT_EQ(2, s3.size());
+    EXPECT_TRUE(s3.contains("HELLO"));
+    EXPECT_FALSE(s3.contains("PERSON"));
+
+    EXPECT_EQ(0, s2.size());
+    s2.add("PERSON");
+    EXPECT_TRUE(s2.contains("PERSON"));
+
+    // Moving never throws, whatever the hash policy, so containers can
+    // move HashSets rather than copying them.
+    EXPECT_TRUE(std::is_nothrow_move_constructible_v<HashSet<std::string>>);
+    EXPECT_TRUE(std::is_nothrow_move_assignable_v<HashSet<std::string>>);
+    EXPECT_TRUE((std::is_nothrow_move_constructible_v<HashSet<std::string, WyHash>>));
+    EXPECT_TRUE((std::is_nothrow_move_assignable_v<HashSet<std::string, WyHash>>));
+}
+
+
+TEST(HashSet_ExtendedTests, eachAddMovesBoundedNumberOfSlotsWhileGrowing)
+{
+    HashSet<int> s{identityHash};
+    bool sawMigration = false;
+
+    for (int i = 0; i < 5000; ++i)
+    {
+        bool wasMigrating = s.isMigrating();
+        unsigned int pendingBefore = s.pendingMigration();
+
+        s.add(i);
+
+        if (wasMigrating)
+        {
+            sawMigration = true;
+
+            // Either this add moved at most MIGRATION_STEP slots, or it
+            // finished the migration and started a fresh one.
+            unsigned int pendingAfter = s.pendingMigration();
+            EXPECT_TRUE(
+                pendingBefore - pendingAfter <= HashSet<int>::MIGRATION_STEP
+                || pendingBefore <= HashSet<int>::MIGRATION_STEP);
+        }
+    }
+
+    EXPECT_TRUE(sawMigration);
+}
+
+
+TEST(HashSet_ExtendedTests, containsElementsInBothTablesWhileMigrating)
+{
+    HashSet<std::string> s{lengthHash};
+    int added = 0;
+
+    while (s.pendingMigration() <= 2 * HashSet<std::string>::MIGRATION_STEP)
+    {
+        s.add(std::string(added % 40, 'A') + std::to_string(added));
+        ++added;
+    }
+
+    s.add("B");
+    ASSERT_TRUE(s.isMigrating());
+
+    for (int i = 0; i < added; ++i)
+    {
+        std::string element = std::string(i % 40, 'A') + std::to_string(i);
+        EXPECT_TRUE(s.contains(element));
+
+        s.add(element);
+    }
+
+    EXPECT_TRUE(s.contains("B"));
+    EXPECT_EQ(added + 1, s.size());
+
+    HashSet<std::string> copy{s};
+    EXPECT_FALSE(copy.isMigrating());
+    EXPECT_EQ(added + 1, copy.size());
+    EXPECT_TRUE(copy.contains("B"));
+}
+
+
+TEST(HashSet_ExtendedTests, canSearchForStringViews)
+{
+    HashSet<std::string> s{lengthHash};
+    s.add("HELLO");
+    s.add("A MUCH LONGER WORD THAN FITS IN A SMALL STRING");
+
+    std::string_view text{"SAY HELLO THERE"};
+
+    EXPECT_TRUE(s.contains(text.substr(4, 5)));
+    EXPECT_FALSE(s.contains(text.substr(4, 4)));
+    EXPECT_TRUE(s.contains("A MUCH LONGER WORD THAN FITS IN A SMALL STRING"));
+    EXPECT_FALSE(s.contains(std::string_view{}));
+}
+
+
+TEST(HashSet_ExtendedTests, canUseBuiltInSeededHash)
+{
+    HashSet<std::string, WyHash> s;
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.add("WORD" + std::to_string(i));
+    }
+
+    EXPECT_EQ(1000, s.size());
+    EXPECT_TRUE(s.contains("WORD999"));
+    EXPECT_TRUE(s.contains(std::string_view{"WORD0 AND MORE"}.substr(0, 5)));
+    EXPECT_FALSE(s.contains("WORD1000"));
+
+    HashSet<int, WyHash> ints{WyHash{12345}};
+    ints.add(-1);
+    ints.add(0);
+    ints.add(1);
+
+    EXPECT_EQ(3, ints.size());
+    EXPECT_TRUE(ints.contains(-1));
+    EXPECT_FALSE(ints.contains(2));
+}
+
+
+TEST(HashSet_ExtendedTests, seededHashesAgreeOnlyWithTheSameSeed)
+{
+    WyHash a{1};
+    WyHash b{1};
+    WyHash c{2};
+
+    std::string shortWord{"BOO"};
+    std::string longWord(100, 'Z');
+
+    EXPECT_EQ(a(shortWord), b(shortWord));
+    EXPECT_EQ(a(longWord), b(std::string_view{longWord}));
+    EXPECT_NE(a(shortWord), c(shortWord));
+    EXPECT_NE(a(longWord), c(longWord));
+    EXPECT_NE(a(shortWord), a(longWord));
+}
+
+
+TEST(HashSet_ExtendedTests, reservingAvoidsGrowingLater)
+{
+    HashSet<int> s{identityHash};
+    s.add(-1);
+    s.reserve(10000);
+
+    for (int i = 0; i < 9999; ++i)
+    {
+        s.add(i);
+        ASSERT_FALSE(s.isMigrating());
+    }
+
+    EXPECT_EQ(10000, s.size());
+    EXPECT_TRUE(s.contains(-1));
+}
+
+
+TEST(HashSet_ExtendedTests, canConstructFromRangeWithDuplicates)
+{
+    std::vector<std::string> words{"HELLO", "THERE", "BOO", "HELLO", "BOO"};
+    HashSet<std::string, WyHash> s{words.begin(), words.end()};
+
+    EXPECT_EQ(3, s.size());
+    EXPECT_TRUE(s.contains("HELLO"));
+    EXPECT_TRUE(s.contains("THERE"));
+    EXPECT_TRUE(s.contains("BOO"));
+
+    std::vector<std::string> more{"BOO", "PERSON"};
+    s.bulkLoad(more.begin(), more.end());
+
+    EXPECT_EQ(4, s.size());
+    EXPECT_TRUE(s.contains("PERSON"));
+}
+
+
+TEST(HashSet_ExtendedTests, canBulkLoadFromInputIterators)
+{
+    std::istringstream in{"HELLO THERE BOO HELLO"};
+    HashSet<std::string> s{lengthHash};
+
+    s.bulkLoad(std::istream_iterator<std::string>{in}, std::istream_iterator<std::string>{});
+
+    EXPECT_EQ(3, s.size());
+    EXPECT_TRUE(s.contains("THERE"));
+}
+
+
+TEST(HashSet_ExtendedTests, statisticsRevealCollidingHashFunction)
+{
+    HashSet<int> colliding{zeroHash<int>};
+    HashSet<int, WyHash> spread;
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        colliding.add(i);
+        spread.add(i);
+    }
+
+    auto bad = colliding.statistics();
+    auto good = spread.statistics();
+
+    EXPECT_EQ(1000, bad.size);
+    EXPECT_EQ(bad.capacity, good.capacity);
+    EXPECT_DOUBLE_EQ(1000.0 / bad.capacity, bad.loadFactor);
+    EXPECT_GT(bad.growthCount, 0);
+    EXPECT_GE(bad.totalBytes, bad.capacity * (1 + sizeof(int)));
+
+    // Every element of the colliding set starts at group 0, so the groups
+    // fill up one after another along the probe sequence.
+    EXPECT_EQ(1000 / ControlGroup::WIDTH + 1, bad.maxProbeLength);
+    EXPECT_GT(bad.meanProbeLength, 10.0);
+    EXPECT_LT(good.meanProbeLength, 1.5);
+
+    unsigned int groups = 0;
+    unsigned int elements = 0;
+
+    for (unsigned int k = 0; k <= ControlGroup::WIDTH; ++k)
+    {
+        groups += good.groupOccupancy[k];
+        elements += k * good.groupOccupancy[k];
+    }
+
+    EXPECT_EQ(good.capacity / ControlGroup::WIDTH, groups);
+    EXPECT_EQ(1000, elements);
+}
+
+
+TEST(HashSet_ExtendedTests, probeCountersAreOptional)
+{
+    HashSet<int> s{zeroHash<int>};
+
+    for (int i = 0; i < 40; ++i)
+    {
+        s.add(i);
+    }
+
+    s.contains(0);
+    EXPECT_EQ(0, s.statistics().probes.searches);
+
+    // Searching for a missing element compares it to every element, in
+    // groups 0, 1, and 3 of the probe sequence.
+    s.setProbeCounting(true);
+    s.contains(1000);
+    s.contains(1001);
+
+    auto probes = s.statistics().probes;
+    EXPECT_EQ(2, probes.searches);
+    EXPECT_EQ(3 + 3, probes.groupsProbed);
+    EXPECT_EQ(40 + 40, probes.comparisons);
+
+    s.resetProbeCounters();
+    EXPECT_EQ(0, s.statistics().probes.searches);
+}
+
+
+TEST(HashSet_ExtendedTests, containsManyAgreesWithContains)
+{
+    HashSet<std::string, WyHash> s;
+    std::vector<std::string> words;
+
+    for (int i = 0; i < 300; ++i)
+    {
+        words.push_back("word" + std::to_string(i));
+    }
+
+    // Adding the words one at a time leaves the set migrating part of the
+    // time, so the batches below see both tables.
+    std::vector<std::string_view> keys;
+    std::vector<std::string> missing;
+
+    for (int i = 0; i < 300; ++i)
+    {
+        missing.push_back("missing" + std::to_string(i));
+    }
+
+    for (int i = 0; i < 300; ++i)
+    {
+        s.add(words[i]);
+
+        keys.assign({words[i], missing[i], words[i / 2]});
+
+        bool found[3];
+        s.containsMany(keys.data(), keys.size(), found);
+
+        ASSERT_TRUE(found[0]);
+        ASSERT_FALSE(found[1]);
+        ASSERT_TRUE(found[2]);
+    }
+
+    keys.assign(words.begin(), words.end());
+    keys.insert(keys.end(), missing.begin(), missing.end());
+
+    std::unique_ptr<bool[]> found{new bool[keys.size()]};
+    s.containsMany(keys.data(), keys.size(), found.get());
+
+    for (unsigned int i = 0; i < keys.size(); ++i)
+    {
+        ASSERT_EQ(s.contains(keys[i]), found[i]);
+        ASSERT_EQ(i < words.size(), found[i]);
+    }
+}
+
+
+TEST(HashSet_ExtendedTests, containsManyWorksWithHashFunctions)
+{
+    HashSet<int> s{identityHash};
+    s.containsMany(nullptr, 0, nullptr);
+
+    for (int i = 0; i < 50; i += 2)
+    {
+        s.add(i);
+    }
+
+    std::vector<int> keys;
+
+    for (int i = 0; i < 50; ++i)
+    {
+        keys.push_back(i);
+    }
+
+    std::unique_ptr<bool[]> found{new bool[keys.size()]};
+    s.containsMany(keys.data(), keys.size(), found.get());
+
+    for (int i = 0; i < 50; ++i)
+    {
+        ASSERT_EQ(i % 2 == 0, found[i]);
+    }
+}
+
+
+TEST(HashSet_ExtendedTests, growingAndCopyingNeverRehash)
+{
+    unsigned int calls = 0;
+    HashSet<int> s{[&calls](const int& i) { ++calls; return static_cast<unsigned int>(i); }};
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.add(i);
+    }
+
+    // Each add() hashes its element once; moving the elements into each
+    // grown table uses the hashes that were kept.
+    EXPECT_EQ(1000, calls);
+
+    HashSet<int> copy{s};
+    s.reserve(5000);
+    EXPECT_EQ(1000, calls);
+    EXPECT_EQ(1000, copy.size());
+}
+
+
+TEST(HashSet_ExtendedTests, elementsAreOnlyComparedWhenWholeHashesMatch)
+{
+    // Every element has the same tag, but a different hash.
+    HashSet<int, SameTagHash> s;
+
+    for (int i = 0; i < 10; ++i)
+    {
+        s.add(i);
+    }
+
+    s.setProbeCounting(true);
+    s.contains(1000);
+    s.contains(5);
+
+    EXPECT_EQ(1, s.statistics().probes.comparisons);
+}
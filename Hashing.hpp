@@ -0,0 +1,303 @@
+// Hashing.hpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// The hash policies that a HashSet can be configured with.  A hash policy
+// is a copyable function object whose operator() takes a key and returns a
+// well-mixed 64-bit hash, i.e., one whose bits are all equally likely to
+// be 0 or 1, since a HashSet uses the low bits of the hash as tags and the
+// bits above them to choose where an element lives.  Because the policy is
+// a template parameter of the HashSet, calls to it are direct (and usually
+// inlined) rather than going through a std::function.
+//
+// Two policies are provided:
+//
+// * FunctionHash adapts an ordinary hash function returning unsigned int,
+//   which is how HashSets were originally configured.  The 32-bit result
+//   is scrambled into 64 bits, since such functions are often weak.
+//
+// * WyHash is a fast, seeded hash in the style of wyhash, for strings
+//   (including std::string_view, so transparent lookups hash the key
+//   directly) and integers.  By default, each process chooses a random
+//   seed, so that nobody can construct a set of inputs that collide in
+//   advance.
+
+#ifndef HASHING_HPP
+#define HASHING_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+
+
+namespace impl_
+{
+    // Hashing__mix() scrambles the bits of its input, so that every bit of
+    // the input affects every bit of the output.  Zero maps to zero.
+    inline std::uint64_t Hashing__mix(std::uint64_t hash) noexcept
+    {
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDULL;
+        hash ^= hash >> 33;
+        hash *= 0xC4CEB9FE1A85EC53ULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+
+    // Hashing__multiplyInPlace() multiplies two 64-bit values, leaving the
+    // low half of the 128-bit product in a and the high half in b.
+    inline void Hashing__multiplyInPlace(std::uint64_t& a, std::uint64_t& b) noexcept
+    {
+#if defined(__SIZEOF_INT128__)
+        // __extension__ keeps -Wpedantic quiet about the non-standard type.
+        __extension__ typedef unsigned __int128 Hashing__uint128;
+        Hashing__uint128 product = static_cast<Hashing__uint128>(a) * b;
+        a = static_cast<std::uint64_t>(product);
+        b = static_cast<std::uint64_t>(product >> 64);
+#else
+        std::uint64_t aLow = a & 0xFFFFFFFF, aHigh = a >> 32;
+        std::uint64_t bLow = b & 0xFFFFFFFF, bHigh = b >> 32;
+
+        std::uint64_t lowLow = aLow * bLow;
+        std::uint64_t lowHigh = aLow * bHigh;
+        std::uint64_t highLow = aHigh * bLow;
+        std::uint64_t highHigh = aHigh * bHigh;
+
+        std::uint64_t middle = (lowLow >> 32) + (lowHigh & 0xFFFFFFFF) + highLow;
+
+        a = (middle << 32) | (lowLow & 0xFFFFFFFF);
+        b = highHigh + (lowHigh >> 32) + (middle >> 32);
+#endif
+    }
+
+
+    // Hashing__multiply() multiplies two 64-bit values and folds the two
+    // halves of their 128-bit product together.
+    inline std::uint64_t Hashing__multiply(std::uint64_t a, std::uint64_t b) noexcept
+    {
+        Hashing__multiplyInPlace(a, b);
+        return a ^ b;
+    }
+
+
+    inline std::uint64_t Hashing__read8(const unsigned char* p) noexcept
+    {
+        std::uint64_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+
+    inline std::uint64_t Hashing__read4(const unsigned char* p) noexcept
+    {
+        std::uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+
+    constexpr std::uint64_t Hashing__SECRET[4] = {
+        0x2D358DCCAA6C78A5ULL, 0x8BB84B93962EACC9ULL,
+        0x4B33A62ED433D4A3ULL, 0x4D5A2DA51DE1AA47ULL
+    };
+}
+
+
+
+// A FunctionHash adapts a function that takes a reference to a const
+// ElementType and returns an unsigned int into a hash policy.
+
+template <typename ElementType>
+class FunctionHash
+{
+public:
+    using HashFunction = std::function<unsigned int(const ElementType&)>;
+
+public:
+    // Initializes a FunctionHash from anything that a HashFunction can be
+    // initialized with, such as a function or a lambda.
+    template <
+        typename Function,
+        typename = std::enable_if_t<
+            !std::is_same_v<std::decay_t<Function>, FunctionHash>
+            && std::is_constructible_v<HashFunction, Function>>>
+    FunctionHash(Function&& function);
+
+    std::uint64_t operator()(const ElementType& element) const;
+
+private:
+    HashFunction function;
+};
+
+
+template <typename ElementType>
+template <typename Function, typename>
+FunctionHash<ElementType>::FunctionHash(Function&& function)
+    : function{std::forward<Function>(function)}
+{
+}
+
+
+template <typename ElementType>
+std::uint64_t FunctionHash<ElementType>::operator()(const ElementType& element) const
+{
+    return impl_::Hashing__mix(function(element));
+}
+
+
+
+// A WyHash hashes strings and integers with a seed.  Two WyHashes with the
+// same seed always agree, but the hashes they produce are otherwise
+// unpredictable.
+
+class WyHash
+{
+public:
+    // Initializes a WyHash with the given seed.  Without one, it uses a
+    // seed chosen at random once per process.
+    WyHash() noexcept;
+    explicit WyHash(std::uint64_t seed) noexcept;
+
+    std::uint64_t operator()(std::string_view s) const noexcept;
+
+    template <typename Integer, typename = std::enable_if_t<std::is_integral_v<Integer>>>
+    std::uint64_t operator()(Integer i) const noexcept;
+
+    std::uint64_t seed() const noexcept;
+
+    // processSeed() returns the seed used by WyHashes that weren't given
+    // one explicitly.
+    static std::uint64_t processSeed();
+
+private:
+    std::uint64_t seedValue;
+};
+
+
+inline WyHash::WyHash() noexcept
+    : WyHash{processSeed()}
+{
+}
+
+
+inline WyHash::WyHash(std::uint64_t seed) noexcept
+    : seedValue{seed ^ impl_::Hashing__multiply(seed ^ impl_::Hashing__SECRET[0], impl_::Hashing__SECRET[1])}
+{
+}
+
+
+inline std::uint64_t WyHash::operator()(std::string_view s) const noexcept
+{
+    using impl_::Hashing__SECRET;
+    using impl_::Hashing__multiply;
+    using impl_::Hashing__multiplyInPlace;
+    using impl_::Hashing__read4;
+    using impl_::Hashing__read8;
+
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(s.data());
+    std::size_t length = s.length();
+    std::uint64_t seed = seedValue;
+    std::uint64_t a;
+    std::uint64_t b;
+
+    if (length <= 16)
+    {
+        if (length >= 4)
+        {
+            std::size_t middle = (length >> 3) << 2;
+            a = (Hashing__read4(p) << 32) | Hashing__read4(p + middle);
+            b = (Hashing__read4(p + length - 4) << 32) | Hashing__read4(p + length - 4 - middle);
+        }
+        else if (length > 0)
+        {
+            a = (static_cast<std::uint64_t>(p[0]) << 16)
+                | (static_cast<std::uint64_t>(p[length >> 1]) << 8)
+                | p[length - 1];
+            b = 0;
+        }
+        else
+        {
+            a = 0;
+            b = 0;
+        }
+    }
+    else
+    {
+        std::size_t remaining = length;
+
+        if (remaining > 48)
+        {
+            std::uint64_t seed1 = seed;
+            std::uint64_t seed2 = seed;
+
+            do
+            {
+                seed = Hashing__multiply(Hashing__read8(p) ^ Hashing__SECRET[1], Hashing__read8(p + 8) ^ seed);
+                seed1 = Hashing__multiply(Hashing__read8(p + 16) ^ Hashing__SECRET[2], Hashing__read8(p + 24) ^ seed1);
+                seed2 = Hashing__multiply(Hashing__read8(p + 32) ^ Hashing__SECRET[3], Hashing__read8(p + 40) ^ seed2);
+                p += 48;
+                remaining -= 48;
+            }
+            while (remaining > 48);
+
+            seed ^= seed1 ^ seed2;
+        }
+
+        while (remaining > 16)
+        {
+            seed = Hashing__multiply(Hashing__read8(p) ^ Hashing__SECRET[1], Hashing__read8(p + 8) ^ seed);
+            p += 16;
+            remaining -= 16;
+        }
+
+        a = Hashing__read8(p + remaining - 16);
+        b = Hashing__read8(p + remaining - 8);
+    }
+
+    a ^= Hashing__SECRET[1];
+    b ^= seed;
+    Hashing__multiplyInPlace(a, b);
+
+    return Hashing__multiply(a ^ Hashing__SECRET[0] ^ length, b ^ Hashing__SECRET[1]);
+}
+
+
+template <typename Integer, typename>
+std::uint64_t WyHash::operator()(Integer i) const noexcept
+{
+    using impl_::Hashing__SECRET;
+
+    std::uint64_t a = static_cast<std::uint64_t>(i) ^ Hashing__SECRET[0];
+    std::uint64_t b = seedValue ^ Hashing__SECRET[1];
+    impl_::Hashing__multiplyInPlace(a, b);
+
+    return impl_::Hashing__multiply(a ^ Hashing__SECRET[0], b ^ Hashing__SECRET[1]);
+}
+
+
+inline std::uint64_t WyHash::seed() const noexcept
+{
+    return seedValue;
+}
+
+
+inline std::uint64_t WyHash::processSeed()
+{
+    static const std::uint64_t seed = [] {
+        std::random_device device;
+        return (static_cast<std::uint64_t>(device()) << 32) ^ device();
+    }();
+
+    return seed;
+}
+
+
+
+#endif
@@ -0,0 +1,42 @@
+// KeyLookup.hpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// The Set implementations allow a Set<std::string> to be searched for a
+// key that isn't a std::string -- a std::string_view, a string literal,
+// or anything else that converts to a std::string_view -- without first
+// materializing a std::string (and, for longer keys, allocating memory)
+// just to search for it.  This is sometimes called a "transparent" or
+// "heterogeneous" lookup.
+//
+// The helpers here decide which key types qualify.  Keys whose type is
+// ElementType itself always use the ordinary contains() instead.
+
+#ifndef KEYLOOKUP_HPP
+#define KEYLOOKUP_HPP
+
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+
+
+namespace impl_
+{
+    template <typename ElementType, typename KeyType>
+    constexpr bool Set__isTransparentKey =
+        std::is_same_v<ElementType, std::string>
+        && !std::is_same_v<std::decay_t<KeyType>, std::string>
+        && std::is_convertible_v<const KeyType&, std::string_view>;
+
+
+    // Set__TransparentKey can be used as a defaulted template parameter to
+    // enable a member function template only for transparent key types.
+    template <typename ElementType, typename KeyType>
+    using Set__TransparentKey = std::enable_if_t<Set__isTransparentKey<ElementType, KeyType>>;
+}
+
+
+
+#endif
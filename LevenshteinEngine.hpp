@@ -0,0 +1,78 @@
+// LevenshteinEngine.hpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A LevenshteinEngine is a SuggestionEngine that suggests every word of a
+// DawgSet within a chosen edit distance of a misspelled word -- not only
+// those one edit away, as a WordChecker finds on its own, but two or three
+// edits away, as is often needed for text that's been through OCR.
+//
+// Generating every candidate two edits away and looking each one up would
+// take about 50 times as long as finding those one edit away.  Instead,
+// the DAWG is walked with the edit distance table alongside it, the way a
+// Levenshtein automaton for the misspelled word would be run against it,
+// so only prefixes of words that could still be close enough are ever
+// visited.  (See DawgSet::findWithinDistance().)
+//
+// Each WordChecker can be given its own LevenshteinEngine, so several of
+// them can share one DawgSet while suggesting words at different
+// distances.
+
+#ifndef LEVENSHTEINENGINE_HPP
+#define LEVENSHTEINENGINE_HPP
+
+#include <string>
+#include <vector>
+#include "DawgSet.hpp"
+#include "SuggestionEngine.hpp"
+
+
+
+class LevenshteinEngine : public SuggestionEngine
+{
+public:
+    // Initializes a LevenshteinEngine that suggests the words of the given
+    // DawgSet within maxDistance edits.  It stores a reference to the
+    // DawgSet, which it searches whenever it needs suggestions.
+    LevenshteinEngine(const DawgSet& words, unsigned int maxDistance);
+
+
+    // findSuggestions() returns the words within the maximum edit distance
+    // of the given word, sorted, including the word itself if it's in the
+    // set.
+    std::vector<std::string> findSuggestions(const std::string& word) const override;
+
+
+    // maxDistance() returns the largest edit distance that a suggestion
+    // can be from the misspelled word.
+    unsigned int maxDistance() const noexcept;
+
+
+private:
+    const DawgSet& words;
+    unsigned int distance;
+};
+
+
+
+inline LevenshteinEngine::LevenshteinEngine(const DawgSet& words, unsigned int maxDistance)
+    : words{words}, distance{maxDistance}
+{
+}
+
+
+inline std::vector<std::string> LevenshteinEngine::findSuggestions(const std::string& word) const
+{
+    return words.findWithinDistance(word, distance);
+}
+
+
+inline unsigned int LevenshteinEngine::maxDistance() const noexcept
+{
+    return distance;
+}
+
+
+
+#endif
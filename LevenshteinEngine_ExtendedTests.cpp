@@ -0,0 +1,145 @@
+// LevenshteinEngine_ExtendedTests.cpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// These unit tests check that a LevenshteinEngine suggests exactly the
+// words within its maximum edit distance, and that WordCheckers sharing
+// one DawgSet can each suggest words at a different distance.
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "DawgSet.hpp"
+#include "HashSet.hpp"
+#include "LevenshteinEngine.hpp"
+#include "WordChecker.hpp"
+
+
+namespace
+{
+    // Counts insertions, deletions, replacements, and swaps of adjacent
+    // characters, the slow and obvious way.
+    unsigned int slowEditDistance(const std::string& a, const std::string& b)
+    {
+        std::vector<std::vector<unsigned int>> d(a.size() + 1, std::vector<unsigned int>(b.size() + 1));
+
+        for (std::size_t i = 0; i <= a.size(); ++i)
+        {
+            for (std::size_t j = 0; j <= b.size(); ++j)
+            {
+                if (i == 0 || j == 0)
+                {
+                    d[i][j] = static_cast<unsigned int>(i + j);
+                    continue;
+                }
+
+                d[i][j] = std::min({d[i - 1][j] + 1, d[i][j - 1] + 1, d[i - 1][j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1)});
+
+                if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1])
+                {
+                    d[i][j] = std::min(d[i][j], d[i - 2][j - 2] + 1);
+                }
+            }
+        }
+
+        return d[a.size()][b.size()];
+    }
+
+
+    std::string randomWord(std::default_random_engine& engine)
+    {
+        std::uniform_int_distribution<int> length{0, 8};
+        std::uniform_int_distribution<int> letter{0, 3};
+
+        std::string word(length(engine), ' ');
+
+        for (char& c : word)
+        {
+            c = static_cast<char>('A' + letter(engine));
+        }
+
+        return word;
+    }
+}
+
+
+TEST(LevenshteinEngine_ExtendedTests, suggestsTheWordsWithinTheMaximumDistance)
+{
+    std::default_random_engine engine{46};
+    std::vector<std::string> dictionary;
+
+    for (int i = 0; i < 500; ++i)
+    {
+        dictionary.push_back(randomWord(engine));
+    }
+
+    DawgSet words{dictionary.begin(), dictionary.end()};
+
+    std::sort(dictionary.begin(), dictionary.end());
+    dictionary.erase(std::unique(dictionary.begin(), dictionary.end()), dictionary.end());
+
+    for (unsigned int maxDistance : {0, 1, 2, 3})
+    {
+        LevenshteinEngine levenshtein{words, maxDistance};
+        ASSERT_EQ(maxDistance, levenshtein.maxDistance());
+
+        for (int i = 0; i < 100; ++i)
+        {
+            std::string word = randomWord(engine);
+            std::vector<std::string> expected;
+
+            for (const std::string& candidate : dictionary)
+            {
+                if (slowEditDistance(word, candidate) <= maxDistance)
+                {
+                    expected.push_back(candidate);
+                }
+            }
+
+            ASSERT_EQ(expected, levenshtein.findSuggestions(word));
+        }
+    }
+}
+
+
+TEST(LevenshteinEngine_ExtendedTests, wordCheckersCanSuggestAtDifferentDistances)
+{
+    std::vector<std::string> dictionary{
+        "SPELLING", "SPELLS", "SPILLING", "SELLING", "SPELUNKING", "DWELLING", "SMELLING"
+    };
+
+    DawgSet dawg{dictionary.begin(), dictionary.end()};
+    HashSet<std::string, WyHash> words;
+
+    for (const std::string& word : dictionary)
+    {
+        words.add(word);
+    }
+
+    LevenshteinEngine near{dawg, 1};
+    LevenshteinEngine far{dawg, 2};
+
+    WordChecker plainChecker{words};
+    WordChecker nearChecker{words, near};
+    WordChecker farChecker{words, far};
+
+    // At distance 1, the engine suggests what the WordChecker would have.
+    for (const char* word : {"SPELING", "SPELLINGG", "PSELLING", "SPELLS", "SPILLIGN"})
+    {
+        EXPECT_EQ(plainChecker.findSuggestions(word), nearChecker.findSuggestions(word));
+    }
+
+    std::vector<std::string> expected{"SPELLING"};
+    EXPECT_EQ(expected, nearChecker.findSuggestions("SPELLNG"));
+
+    expected = {"SELLING", "SMELLING", "SPELLING", "SPELLS", "SPILLING"};
+    EXPECT_EQ(expected, farChecker.findSuggestions("SPELLNG"));
+
+    // A missing letter and a swap are two edits.
+    expected = {"SPELLING"};
+    EXPECT_EQ(expected, farChecker.findSuggestions("SPELIGN"));
+    EXPECT_TRUE(nearChecker.findSuggestions("SPELIGN").empty());
+}
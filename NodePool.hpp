@@ -0,0 +1,205 @@
+// NodePool.hpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A NodePool hands out nodes for a linked data structure, carving them out
+// of large, contiguous "slabs" rather than allocating each one separately.
+// This makes creating a node little more than incrementing a counter, keeps
+// nodes created around the same time next to one another in memory, and
+// avoids the per-allocation overhead of the memory allocator.
+//
+// Nodes can't be given back individually -- which suits a Set, since its
+// elements are never removed -- but clear() destroys all of them and
+// releases every slab at once, without walking the data structure.
+//
+// Slabs start small, so that small sets stay small, and double in size up
+// to MAX_SLAB_NODES nodes, so that large sets need few of them.
+
+#ifndef NODEPOOL_HPP
+#define NODEPOOL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+
+
+template <typename NodeType>
+class NodePool
+{
+public:
+    static constexpr unsigned int MIN_SLAB_NODES = 32;
+    static constexpr unsigned int MAX_SLAB_NODES = 16384;
+
+public:
+    // Initializes a NodePool with no slabs.
+    NodePool() noexcept;
+
+    // Destroys all of the nodes and releases all of the slabs.
+    ~NodePool() noexcept;
+
+    NodePool(const NodePool& p) = delete;
+    NodePool& operator=(const NodePool& p) = delete;
+
+    // Initializes a NodePool that takes over the nodes of an expiring one.
+    NodePool(NodePool&& p) noexcept;
+
+    // Swaps the nodes of an expiring NodePool with those of this one.
+    NodePool& operator=(NodePool&& p) noexcept;
+
+
+    // create() constructs a new node from the given arguments and returns
+    // a pointer to it, which remains valid until the pool is cleared.
+    template <typename... Args>
+    NodeType* create(Args&&... args);
+
+
+    // clear() destroys all of the nodes and releases all of the slabs.
+    void clear() noexcept;
+
+
+    // size() returns the number of nodes created since the pool was last
+    // cleared.
+    std::size_t size() const noexcept;
+
+
+    // bytes() returns the total size of the slabs.
+    std::size_t bytes() const noexcept;
+
+
+private:
+    struct Slab
+    {
+        NodeType* nodes;
+        unsigned int capacity;
+        unsigned int used;
+        Slab* previous;
+    };
+
+    // The most recently allocated slab, which is the only one that might
+    // have room left in it.
+    Slab* current;
+    std::size_t nodeCount;
+    std::size_t slabBytes;
+};
+
+
+
+template <typename NodeType>
+NodePool<NodeType>::NodePool() noexcept
+    : current{nullptr}, nodeCount{0}, slabBytes{0}
+{
+}
+
+
+template <typename NodeType>
+NodePool<NodeType>::~NodePool() noexcept
+{
+    clear();
+}
+
+
+template <typename NodeType>
+NodePool<NodeType>::NodePool(NodePool&& p) noexcept
+    : current{nullptr}, nodeCount{0}, slabBytes{0}
+{
+    std::swap(current, p.current);
+    std::swap(nodeCount, p.nodeCount);
+    std::swap(slabBytes, p.slabBytes);
+}
+
+
+template <typename NodeType>
+NodePool<NodeType>& NodePool<NodeType>::operator=(NodePool&& p) noexcept
+{
+    std::swap(current, p.current);
+    std::swap(nodeCount, p.nodeCount);
+    std::swap(slabBytes, p.slabBytes);
+
+    return *this;
+}
+
+
+template <typename NodeType>
+template <typename... Args>
+NodeType* NodePool<NodeType>::create(Args&&... args)
+{
+    if (current == nullptr || current->used == current->capacity)
+    {
+        unsigned int capacity = MIN_SLAB_NODES;
+
+        if (current != nullptr)
+        {
+            capacity = current->capacity * 2;
+
+            if (capacity > MAX_SLAB_NODES)
+            {
+                capacity = MAX_SLAB_NODES;
+            }
+        }
+
+        Slab* slab = new Slab{nullptr, capacity, 0, current};
+
+        try
+        {
+            slab->nodes = std::allocator<NodeType>{}.allocate(capacity);
+        }
+        catch (...)
+        {
+            delete slab;
+            throw;
+        }
+
+        current = slab;
+        slabBytes += sizeof(Slab) + static_cast<std::size_t>(capacity) * sizeof(NodeType);
+    }
+
+    NodeType* node = new (current->nodes + current->used) NodeType{std::forward<Args>(args)...};
+    ++current->used;
+    ++nodeCount;
+
+    return node;
+}
+
+
+template <typename NodeType>
+void NodePool<NodeType>::clear() noexcept
+{
+    while (current != nullptr)
+    {
+        Slab* previous = current->previous;
+
+        for (unsigned int i = 0; i < current->used; ++i)
+        {
+            current->nodes[i].~NodeType();
+        }
+
+        std::allocator<NodeType>{}.deallocate(current->nodes, current->capacity);
+        delete current;
+
+        current = previous;
+    }
+
+    nodeCount = 0;
+    slabBytes = 0;
+}
+
+
+template <typename NodeType>
+std::size_t NodePool<NodeType>::size() const noexcept
+{
+    return nodeCount;
+}
+
+
+template <typename NodeType>
+std::size_t NodePool<NodeType>::bytes() const noexcept
+{
+    return slabBytes;
+}
+
+
+
+#endif
@@ -4,7 +4,11 @@
 // Project #4: Set the Controls for the Heart of the Sun
 //
 // A SkipListSet is an implementation of a Set that is a skip list, implemented
-// as we discussed in lecture.  A skip list is a sequence of levels
+// as we discussed in lecture.  A skip list is a sequence of levels, each a
+// sorted linked list of the elements that occupy it, with every element on
+// level 0 and roughly half of the elements on each level also occupying the
+// level above it.  A search starts on the top level, moving forward until
+// the next element is too large, then drops down a level and continues.
 //
 // You are not permitted to use the containers in the C++ Standard Library
 // (such as std::set, std::map, or std::vector) to store the keys and their
@@ -12,10 +16,19 @@
 // nodes, with pointers connecting them.  You can, however, use other parts of
 // the C++ Standard Library -- including <random>, notably.
 //
-// Each node should contain only two pointers: one to the node that follows it
-// on the same level and another to the equivalent node on the level below it.
-// Additional pointers use more memory but don't enable any techniques not
-// enabled by the other two.
+// Each element is stored once, in a single allocation holding the element
+// followed by its "tower": one pointer to the following node on each level
+// the element occupies.  Dropping down a level is just moving to the next
+// pointer in the same tower, so there are no separate nodes (and no copies
+// of the element) on the upper levels, and the expected memory used per
+// element is the element and two pointers.  The front of every level is
+// held by the SkipListSet itself, and the end of every level is a null
+// pointer, so -INF and +INF needn't be stored.
+//
+// A new element's level is chosen by "flipping coins" with the level tester,
+// but never more than one level above the current top level (so that an
+// unlucky run of flips can't make the list needlessly tall) or beyond
+// MAX_LEVEL_COUNT levels.
 //
 // A couple of utilities are included here: SkipListKind and SkipListKey.
 // You can feel free to use these as-is and probably will not need to
@@ -24,9 +37,16 @@
 #ifndef SKIPLISTSET_HPP
 #define SKIPLISTSET_HPP
 
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
 #include <memory>
+#include <new>
 #include <optional>
 #include <random>
+#include <string_view>
+#include <utility>
+#include "KeyLookup.hpp"
 #include "Set.hpp"
 
 
@@ -215,6 +235,39 @@ std::unique_ptr<SkipListLevelTester<ElementType>> RandomSkipListLevelTester<Elem
 template <typename ElementType>
 class SkipListSet : public Set<ElementType>
 {
+public:
+    // The most levels that a SkipListSet will have.  With each element
+    // occupying the next level half of the time, it would take billions of
+    // elements before this limit had any effect.
+    static constexpr unsigned int MAX_LEVEL_COUNT = 32;
+
+private:
+    struct Node;
+
+public:
+    // A Finger remembers where the last add() or contains() it was passed
+    // to ended: the last node before that element on each level.  Starting
+    // the next search from there, rather than from the top of the list,
+    // takes an expected time of O(log d) instead of O(log n), where d is the
+    // number of elements between the two, so searching for elements in
+    // ascending order (or in any order with locality) is much faster.  A
+    // Finger that was used with another SkipListSet, or with this one before
+    // it was changed by something other than the Finger, is ignored, and the
+    // search starts from the top.  Each thread searching a SkipListSet with
+    // a Finger needs its own.
+    class Finger
+    {
+    public:
+        Finger() noexcept;
+
+    private:
+        friend class SkipListSet;
+
+        const SkipListSet* set;
+        unsigned long version;
+        Node* path[MAX_LEVEL_COUNT];
+    };
+
 public:
     // Initializes an SkipListSet to be empty, with or without a
     // "level tester" object that will decide, whenever a "coin flip"
@@ -222,6 +275,13 @@ public:
     SkipListSet();
     explicit SkipListSet(std::unique_ptr<SkipListLevelTester<ElementType>> levelTester);
 
+    // Initializes a SkipListSet to contain the elements in the range
+    // [first, last), as though they were passed to bulkLoad().
+    template <
+        typename InputIterator,
+        typename = typename std::iterator_traits<InputIterator>::iterator_category>
+    SkipListSet(InputIterator first, InputIterator last);
+
     // Cleans up the SkipListSet so that it leaks no memory.
     ~SkipListSet() noexcept override;
 
@@ -247,10 +307,28 @@ public:
     // add() adds an element to the set.  If the element is already in the set,
     // this function has no effect.  This function runs in an expected time
     // of O(log n) (i.e., over the long run, we expect the average to be
-    // O(log n)) with very high probability.
+    // O(log n)) with very high probability.  Each add() starts from where
+    // the previous one ended (see Finger), so adding elements in ascending
+    // order takes only O(1) expected time per element.
     void add(const ElementType& element) override;
 
 
+    // add() can also be given a Finger, which it starts from, then leaves at
+    // the element it added.
+    void add(const ElementType& element, Finger& finger);
+
+
+    // bulkLoad() adds the elements in the range [first, last) to the set.
+    // For as long as each element is larger than every element already in
+    // the set (as it would be when loading a sorted word list), it's simply
+    // linked onto the end of each of its levels, with no searching at all,
+    // so the whole list is built in one linear pass; duplicates are
+    // skipped.  If an element turns out to be out of order, it and the rest
+    // are added one at a time.
+    template <typename InputIterator>
+    void bulkLoad(InputIterator first, InputIterator last);
+
+
     // contains() returns true if the given element is already in the set,
     // false otherwise.  This function runs in an expected time of O(log n)
     // (i.e., over the long run, we expect the average to be O(log n))
@@ -258,6 +336,22 @@ public:
     bool contains(const ElementType& element) const override;
 
 
+    // contains() can also be given a Finger, which it starts from, then
+    // leaves at the element it searched for.
+    bool contains(const ElementType& element, Finger& finger) const;
+
+
+    // contains() can also be given a key of another type that can be
+    // compared to the elements directly -- for a SkipListSet<std::string>,
+    // a std::string_view or a string literal -- so that the caller needn't
+    // build an ElementType just to search for it.  (See KeyLookup.hpp.)
+    template <typename KeyType, typename = impl_::Set__TransparentKey<ElementType, KeyType>>
+    bool contains(const KeyType& key) const;
+
+    template <typename KeyType, typename = impl_::Set__TransparentKey<ElementType, KeyType>>
+    bool contains(const KeyType& key, Finger& finger) const;
+
+
     // size() returns the number of elements in the set.
     unsigned int size() const noexcept override;
 
@@ -284,20 +378,50 @@ public:
 private:
     std::unique_ptr<SkipListLevelTester<ElementType>> levelTester;
 
-    // You'll no doubt want to add member variables and "helper" member
-    // functions here.
-    
+    // A Node is allocated with room for "height" pointers after it, which
+    // forward() returns; forward()[i] is the following node on level i.
     struct Node
     {
         ElementType key;
-        Node* next;
-        Node* down;
+        unsigned int height;
+
+        Node** forward() noexcept;
+        Node* const* forward() const noexcept;
     };
-    
-    int level;
-    //std::unique_ptr<SkipListLevelTester<ElementType>> head;
-    Node** head;
-    int sz;
+
+    // The tower of pointers begins at the first suitably-aligned position
+    // after the Node.
+    static constexpr std::size_t TOWER_OFFSET =
+        (sizeof(Node) + alignof(Node*) - 1) / alignof(Node*) * alignof(Node*);
+
+    // head[i] is the first node on level i, or nullptr if it's empty; it's
+    // the tower of -INF, in effect.
+    Node* head[MAX_LEVEL_COUNT];
+    unsigned int levels;
+    unsigned int elementCounts[MAX_LEVEL_COUNT];
+
+    // The version changes whenever the list does, so that out-of-date
+    // Fingers can be recognized.
+    unsigned long version;
+
+    // The Finger that add() uses when it isn't given one.
+    Finger lastAdd;
+
+private:
+    static Node* createNode(const ElementType& element, unsigned int height);
+    static void destroyNode(Node* node) noexcept;
+    void destroyAll() noexcept;
+    void reset() noexcept;
+
+    Node** towerOf(Node* node) noexcept;
+    Node* const* towerOf(const Node* node) const noexcept;
+    unsigned int chooseHeight(const ElementType& element);
+
+    template <typename KeyType>
+    const Node* find(const KeyType& key) const;
+
+    template <typename KeyType>
+    Node* search(const KeyType& key, Finger& finger) const;
 };
 
 
@@ -306,9 +430,6 @@ template <typename ElementType>
 SkipListSet<ElementType>::SkipListSet()
     : SkipListSet{std::make_unique<RandomSkipListLevelTester<ElementType>>()}
 {
-    level = 0;
-    head = nullptr;
-    sz = 0;
 }
 
 
@@ -316,34 +437,89 @@ template <typename ElementType>
 SkipListSet<ElementType>::SkipListSet(std::unique_ptr<SkipListLevelTester<ElementType>> levelTester)
     : levelTester{std::move(levelTester)}
 {
-    //std::swap(head, levelTester);
-    level = 0;
-    head = nullptr;
-    sz = 0;
+    reset();
+}
+
+
+template <typename ElementType>
+template <typename InputIterator, typename>
+SkipListSet<ElementType>::SkipListSet(InputIterator first, InputIterator last)
+    : SkipListSet{}
+{
+    bulkLoad(first, last);
 }
 
 
 template <typename ElementType>
 SkipListSet<ElementType>::~SkipListSet() noexcept
-{    
+{
+    destroyAll();
 }
 
 
 template <typename ElementType>
 SkipListSet<ElementType>::SkipListSet(const SkipListSet& s)
+    : levelTester{s.levelTester != nullptr ? s.levelTester->clone() : nullptr}
 {
+    reset();
+
+    // The nodes are copied in order along level 0, each with the same
+    // height as the original, so the copy has the same shape; tails[i] is
+    // where the next node on level i is linked.
+    Node** tails[MAX_LEVEL_COUNT];
+
+    for (unsigned int i = 0; i < MAX_LEVEL_COUNT; ++i)
+    {
+        tails[i] = &head[i];
+    }
+
+    try
+    {
+        for (const Node* node = s.head[0]; node != nullptr; node = node->forward()[0])
+        {
+            Node* copy = createNode(node->key, node->height);
+
+            for (unsigned int i = 0; i < node->height; ++i)
+            {
+                *tails[i] = copy;
+                tails[i] = &copy->forward()[i];
+            }
+        }
+    }
+    catch (...)
+    {
+        destroyAll();
+        throw;
+    }
+
+    levels = s.levels;
+
+    for (unsigned int i = 0; i < MAX_LEVEL_COUNT; ++i)
+    {
+        elementCounts[i] = s.elementCounts[i];
+    }
 }
 
 
 template <typename ElementType>
 SkipListSet<ElementType>::SkipListSet(SkipListSet&& s) noexcept
 {
+    // The expiring SkipListSet is left empty, with no level tester, so
+    // anything added to it occupies only level 0.
+    reset();
+    *this = std::move(s);
 }
 
 
 template <typename ElementType>
 SkipListSet<ElementType>& SkipListSet<ElementType>::operator=(const SkipListSet& s)
 {
+    if (this != &s)
+    {
+        SkipListSet temp(s);
+        *this = std::move(temp);
+    }
+
     return *this;
 }
 
@@ -351,6 +527,15 @@ SkipListSet<ElementType>& SkipListSet<ElementType>::operator=(const SkipListSet&
 template <typename ElementType>
 SkipListSet<ElementType>& SkipListSet<ElementType>::operator=(SkipListSet&& s) noexcept
 {
+    std::swap(levelTester, s.levelTester);
+    std::swap(head, s.head);
+    std::swap(levels, s.levels);
+    std::swap(elementCounts, s.elementCounts);
+
+    // Both lists have changed, so any Finger used with either is now out of
+    // date.
+    version = s.version = std::max(version, s.version) + 1;
+
     return *this;
 }
 
@@ -365,44 +550,380 @@ bool SkipListSet<ElementType>::isImplemented() const noexcept
 template <typename ElementType>
 void SkipListSet<ElementType>::add(const ElementType& element)
 {
+    add(element, lastAdd);
+}
+
+
+template <typename ElementType>
+void SkipListSet<ElementType>::add(const ElementType& element, Finger& finger)
+{
+    Node* next = search(element, finger);
+
+    if (next != nullptr && !(element < next->key))
+    {
+        return;
+    }
+
+    unsigned int height = chooseHeight(element);
+
+    for (; levels < height; ++levels)
+    {
+        finger.path[levels] = nullptr;
+    }
+
+    // The finger's path holds the last node before the element on each
+    // level, which is where the new node is linked in.
+    Node* node = createNode(element, height);
+
+    for (unsigned int i = 0; i < height; ++i)
+    {
+        Node** forward = towerOf(finger.path[i]);
+        node->forward()[i] = forward[i];
+        forward[i] = node;
+        ++elementCounts[i];
+    }
+
+    finger.version = ++version;
+}
+
+
+template <typename ElementType>
+template <typename InputIterator>
+void SkipListSet<ElementType>::bulkLoad(InputIterator first, InputIterator last)
+{
+    // tails[i] is the last node on level i, or nullptr if the level is
+    // empty, which is found by searching for a key larger than any other.
+    Node* tails[MAX_LEVEL_COUNT];
+    Node* tail = nullptr;
+
+    for (unsigned int i = MAX_LEVEL_COUNT; i-- > 0; )
+    {
+        if (i < levels)
+        {
+            for (Node* next = towerOf(tail)[i]; next != nullptr; next = towerOf(tail)[i])
+            {
+                tail = next;
+            }
+        }
+
+        tails[i] = tail;
+    }
+
+    for (; first != last; ++first)
+    {
+        const ElementType& element = *first;
+
+        if (tails[0] != nullptr && !(tails[0]->key < element))
+        {
+            if (element < tails[0]->key)
+            {
+                break;
+            }
+
+            continue;
+        }
+
+        unsigned int height = chooseHeight(element);
+        Node* node = createNode(element, height);
+
+        for (unsigned int i = 0; i < height; ++i)
+        {
+            towerOf(tails[i])[i] = node;
+            tails[i] = node;
+            ++elementCounts[i];
+        }
+
+        if (height > levels)
+        {
+            levels = height;
+        }
+
+        ++version;
+    }
+
+    for (; first != last; ++first)
+    {
+        add(*first);
+    }
 }
 
 
 template <typename ElementType>
 bool SkipListSet<ElementType>::contains(const ElementType& element) const
 {
-    return false;
+    return find(element) != nullptr;
+}
+
+
+template <typename ElementType>
+template <typename KeyType, typename>
+bool SkipListSet<ElementType>::contains(const KeyType& key) const
+{
+    return find(std::string_view{key}) != nullptr;
+}
+
+
+template <typename ElementType>
+bool SkipListSet<ElementType>::contains(const ElementType& element, Finger& finger) const
+{
+    const Node* node = search(element, finger);
+    return node != nullptr && node->key == element;
+}
+
+
+template <typename ElementType>
+template <typename KeyType, typename>
+bool SkipListSet<ElementType>::contains(const KeyType& key, Finger& finger) const
+{
+    std::string_view view{key};
+    const Node* node = search(view, finger);
+    return node != nullptr && node->key == view;
+}
+
+
+// find() returns the node containing the given key, or nullptr if there
+// is none.  The node that stops the search on one level often stops it on
+// the levels below, too, so it isn't compared to the key again.
+template <typename ElementType>
+template <typename KeyType>
+const typename SkipListSet<ElementType>::Node* SkipListSet<ElementType>::find(const KeyType& key) const
+{
+    Node* const* forward = head;
+    const Node* stop = nullptr;
+
+    for (unsigned int i = levels; i-- > 0; )
+    {
+        for (const Node* next = forward[i]; next != stop && next != nullptr && next->key < key; next = forward[i])
+        {
+            forward = next->forward();
+        }
+
+        stop = forward[i];
+    }
+
+    return stop != nullptr && stop->key == key ? stop : nullptr;
+}
+
+
+// search() stores into the finger's path the last node before the key on
+// each level (or nullptr, for the head of the level), and returns the first
+// node on level 0 that isn't before the key, or nullptr if there is none.
+//
+// If the finger is up to date, its path is the one to some earlier key, and
+// the search climbs it from level 0 until it reaches a level whose node on
+// the path is before the key and on which the next node above isn't --
+// which, for a key d elements away, is about log2(d) levels up -- then
+// descends from there.  The path above that level is already right.
+template <typename ElementType>
+template <typename KeyType>
+typename SkipListSet<ElementType>::Node* SkipListSet<ElementType>::search(const KeyType& key, Finger& finger) const
+{
+    unsigned int level = levels - 1;
+    Node* start = nullptr;
+
+    if (finger.set == this && finger.version == version)
+    {
+        for (level = 0; level + 1 < levels; ++level)
+        {
+            Node* node = finger.path[level];
+
+            if (node == nullptr || node->key < key)
+            {
+                Node* next = towerOf(finger.path[level + 1])[level + 1];
+
+                if (next == nullptr || !(next->key < key))
+                {
+                    break;
+                }
+            }
+        }
+
+        start = finger.path[level];
+
+        if (start != nullptr && !(start->key < key))
+        {
+            start = nullptr;
+        }
+    }
+
+    finger.set = this;
+    finger.version = version;
+
+    Node* stop = nullptr;
+
+    for (unsigned int i = level + 1; i-- > 0; )
+    {
+        Node* const* forward = towerOf(start);
+
+        for (Node* next = forward[i]; next != stop && next != nullptr && next->key < key; next = forward[i])
+        {
+            start = next;
+            forward = next->forward();
+        }
+
+        stop = forward[i];
+        finger.path[i] = start;
+    }
+
+    return stop;
 }
 
 
 template <typename ElementType>
 unsigned int SkipListSet<ElementType>::size() const noexcept
 {
-    return 0;
+    return elementCounts[0];
 }
 
 
 template <typename ElementType>
 unsigned int SkipListSet<ElementType>::levelCount() const noexcept
 {
-    return 0;
+    return levels;
 }
 
 
 template <typename ElementType>
 unsigned int SkipListSet<ElementType>::elementsOnLevel(unsigned int level) const noexcept
 {
-    return 0;
+    return level < levels ? elementCounts[level] : 0;
 }
 
 
 template <typename ElementType>
 bool SkipListSet<ElementType>::isElementOnLevel(const ElementType& element, unsigned int level) const
 {
-    return false;
+    const Node* node = find(element);
+    return node != nullptr && level < node->height;
 }
 
 
+// createNode() allocates a node with room for a tower of the given height,
+// with all of its pointers null.
+template <typename ElementType>
+typename SkipListSet<ElementType>::Node* SkipListSet<ElementType>::createNode(
+    const ElementType& element, unsigned int height)
+{
+    void* memory = ::operator new(TOWER_OFFSET + height * sizeof(Node*));
+    Node* node;
 
-#endif
+    try
+    {
+        node = new (memory) Node{element, height};
+    }
+    catch (...)
+    {
+        ::operator delete(memory);
+        throw;
+    }
+
+    Node** tower = node->forward();
+
+    for (unsigned int i = 0; i < height; ++i)
+    {
+        new (&tower[i]) Node*{nullptr};
+    }
+
+    return node;
+}
+
+
+template <typename ElementType>
+void SkipListSet<ElementType>::destroyNode(Node* node) noexcept
+{
+    node->~Node();
+    ::operator delete(node);
+}
+
+
+// destroyAll() destroys every node, following level 0, which they all
+// occupy, then leaves the SkipListSet empty.
+template <typename ElementType>
+void SkipListSet<ElementType>::destroyAll() noexcept
+{
+    Node* node = head[0];
 
+    while (node != nullptr)
+    {
+        Node* next = node->forward()[0];
+        destroyNode(node);
+        node = next;
+    }
+
+    reset();
+}
+
+
+// reset() makes the SkipListSet empty, without destroying any nodes.  An
+// empty skip list still has one (empty) level.
+template <typename ElementType>
+void SkipListSet<ElementType>::reset() noexcept
+{
+    for (unsigned int i = 0; i < MAX_LEVEL_COUNT; ++i)
+    {
+        head[i] = nullptr;
+        elementCounts[i] = 0;
+    }
+
+    levels = 1;
+    version = 0;
+}
+
+
+// towerOf() returns the tower of pointers of the given node, or, if it's
+// nullptr, the head of every level.
+template <typename ElementType>
+typename SkipListSet<ElementType>::Node** SkipListSet<ElementType>::towerOf(Node* node) noexcept
+{
+    return node != nullptr ? node->forward() : head;
+}
+
+
+template <typename ElementType>
+typename SkipListSet<ElementType>::Node* const* SkipListSet<ElementType>::towerOf(const Node* node) const noexcept
+{
+    return node != nullptr ? node->forward() : head;
+}
+
+
+// chooseHeight() flips coins with the level tester for a new node's height,
+// which is never more than one level above the current top level nor more
+// than MAX_LEVEL_COUNT.
+template <typename ElementType>
+unsigned int SkipListSet<ElementType>::chooseHeight(const ElementType& element)
+{
+    unsigned int height = 1;
+
+    while (height <= levels && height < MAX_LEVEL_COUNT
+        && levelTester != nullptr && levelTester->shouldOccupyNextLevel(element))
+    {
+        ++height;
+    }
+
+    return height;
+}
+
+
+template <typename ElementType>
+typename SkipListSet<ElementType>::Node** SkipListSet<ElementType>::Node::forward() noexcept
+{
+    return reinterpret_cast<Node**>(reinterpret_cast<char*>(this) + TOWER_OFFSET);
+}
+
+
+template <typename ElementType>
+typename SkipListSet<ElementType>::Node* const* SkipListSet<ElementType>::Node::forward() const noexcept
+{
+    return reinterpret_cast<Node* const*>(reinterpret_cast<const char*>(this) + TOWER_OFFSET);
+}
+
+
+template <typename ElementType>
+SkipListSet<ElementType>::Finger::Finger() noexcept
+    : set{nullptr}, version{0}, path{}
+{
+}
+
+
+
+#endif
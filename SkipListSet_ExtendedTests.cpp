@@ -0,0 +1,306 @@
+// SkipListSet_ExtendedTests.cpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// These unit tests go beyond the sanity-checking tests, checking that a
+// SkipListSet finds what's added to it however the levels turn out, that
+// the levels are limited as described in SkipListSet.hpp, that copies
+// have the same shape as the originals, and that bulk loads and searches
+// that start from a Finger agree with ordinary ones.
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <gtest/gtest.h>
+#include "SkipListSet.hpp"
+
+
+namespace
+{
+    template <typename ElementType>
+    class AlwaysGrowSkipListLevelTester : public SkipListLevelTester<ElementType>
+    {
+    public:
+        bool shouldOccupyNextLevel(const ElementType&) override
+        {
+            return true;
+        }
+
+        std::unique_ptr<SkipListLevelTester<ElementType>> clone() override
+        {
+            return std::make_unique<AlwaysGrowSkipListLevelTester>();
+        }
+    };
+
+
+    class EvenGrowsSkipListLevelTester : public SkipListLevelTester<int>
+    {
+    public:
+        bool shouldOccupyNextLevel(const int& element) override
+        {
+            return element % 2 == 0;
+        }
+
+        std::unique_ptr<SkipListLevelTester<int>> clone() override
+        {
+            return std::make_unique<EvenGrowsSkipListLevelTester>();
+        }
+    };
+}
+
+
+TEST(SkipListSet_ExtendedTests, containsElementsAddedInAnyOrder)
+{
+    std::vector<int> elements;
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        elements.push_back(i * 2);
+    }
+
+    std::shuffle(elements.begin(), elements.end(), std::default_random_engine{46});
+
+    SkipListSet<int> s;
+
+    for (int element : elements)
+    {
+        s.add(element);
+        s.add(element);
+    }
+
+    ASSERT_EQ(20000, s.size());
+    ASSERT_EQ(20000, s.elementsOnLevel(0));
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        ASSERT_TRUE(s.contains(i * 2));
+        ASSERT_FALSE(s.contains(i * 2 + 1));
+    }
+
+    ASSERT_FALSE(s.contains(-1));
+
+    // With each level holding about half of the one below it, the levels
+    // thin out, and there are about log2(n) of them.
+    EXPECT_LT(s.elementsOnLevel(1), 12000);
+    EXPECT_GT(s.elementsOnLevel(1), 8000);
+    EXPECT_LT(s.levelCount(), 32);
+}
+
+
+TEST(SkipListSet_ExtendedTests, levelsGrowByAtMostOneAtATime)
+{
+    SkipListSet<int> s{std::make_unique<AlwaysGrowSkipListLevelTester<int>>()};
+
+    ASSERT_EQ(1, s.levelCount());
+
+    for (int i = 0; i < 40; ++i)
+    {
+        s.add(i);
+        ASSERT_EQ(std::min(i + 2, 32), s.levelCount());
+    }
+
+    // Elements 30 through 39 all reached the highest level.
+    EXPECT_EQ(40, s.elementsOnLevel(0));
+    EXPECT_EQ(10, s.elementsOnLevel(31));
+    EXPECT_EQ(0, s.elementsOnLevel(32));
+    EXPECT_TRUE(s.isElementOnLevel(39, 31));
+    EXPECT_FALSE(s.isElementOnLevel(0, 2));
+}
+
+
+TEST(SkipListSet_ExtendedTests, elementsAreOnTheLevelsTheTesterChooses)
+{
+    SkipListSet<int> s{std::make_unique<EvenGrowsSkipListLevelTester>()};
+
+    for (int i = 0; i < 10; ++i)
+    {
+        s.add(i);
+    }
+
+    for (int i = 0; i < 10; ++i)
+    {
+        EXPECT_TRUE(s.isElementOnLevel(i, 0));
+        EXPECT_EQ(i % 2 == 0, s.isElementOnLevel(i, 1));
+    }
+
+    EXPECT_EQ(5, s.elementsOnLevel(1));
+    EXPECT_FALSE(s.isElementOnLevel(10, 0));
+    EXPECT_FALSE(s.isElementOnLevel(0, s.levelCount()));
+}
+
+
+TEST(SkipListSet_ExtendedTests, copiesHaveTheSameLevelsAndAreIndependent)
+{
+    SkipListSet<std::string> s1;
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        s1.add("WORD" + std::to_string(i));
+    }
+
+    SkipListSet<std::string> s2{s1};
+    s2.add("BOO");
+
+    // Adding BOO to the copy can add at most one level to it.
+    ASSERT_GE(s2.levelCount(), s1.levelCount());
+    ASSERT_LE(s2.levelCount(), s1.levelCount() + 1);
+
+    for (unsigned int level = 1; level < s1.levelCount(); ++level)
+    {
+        EXPECT_EQ(s1.elementsOnLevel(level), s2.elementsOnLevel(level) - (s2.isElementOnLevel("BOO", level) ? 1 : 0));
+        EXPECT_EQ(s1.isElementOnLevel("WORD7", level), s2.isElementOnLevel("WORD7", level));
+    }
+
+    EXPECT_EQ(1000, s1.size());
+    EXPECT_EQ(1001, s2.size());
+    EXPECT_FALSE(s1.contains("BOO"));
+    EXPECT_TRUE(s2.contains("BOO"));
+
+    SkipListSet<std::string> s3{std::move(s2)};
+    EXPECT_EQ(1001, s3.size());
+    EXPECT_EQ(0, s2.size());
+
+    s2.add("AGAIN");
+    EXPECT_TRUE(s2.contains("AGAIN"));
+}
+
+
+TEST(SkipListSet_ExtendedTests, canSearchForStringViews)
+{
+    SkipListSet<std::string> s;
+    s.add("BOO");
+    s.add("HELLO");
+    s.add("THERE");
+
+    std::string_view text{"SAY HELLO THERE"};
+
+    EXPECT_TRUE(s.contains(text.substr(4, 5)));
+    EXPECT_TRUE(s.contains(text.substr(10)));
+    EXPECT_FALSE(s.contains(text.substr(0, 3)));
+    EXPECT_TRUE(s.contains("BOO"));
+}
+
+
+TEST(SkipListSet_ExtendedTests, bulkLoadingSortedElementsLinksEveryLevel)
+{
+    std::vector<int> elements;
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        elements.push_back(i * 2);
+        elements.push_back(i * 2);
+    }
+
+    SkipListSet<int> s{elements.begin(), elements.end()};
+
+    ASSERT_EQ(20000, s.size());
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        ASSERT_TRUE(s.contains(i * 2));
+        ASSERT_FALSE(s.contains(i * 2 + 1));
+    }
+
+    EXPECT_LT(s.elementsOnLevel(1), 12000);
+    EXPECT_GT(s.elementsOnLevel(1), 8000);
+
+    // Elements that belong after the last one are appended, and the rest
+    // are added where they belong.
+    std::vector<int> more{40000, 40002, 1, 3, -1, 40004};
+    s.bulkLoad(more.begin(), more.end());
+
+    EXPECT_EQ(20006, s.size());
+
+    for (int element : more)
+    {
+        EXPECT_TRUE(s.contains(element));
+    }
+}
+
+
+TEST(SkipListSet_ExtendedTests, bulkLoadingFollowsTheTester)
+{
+    std::vector<int> elements{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    SkipListSet<int> s{std::make_unique<EvenGrowsSkipListLevelTester>()};
+    s.bulkLoad(elements.begin(), elements.end());
+
+    for (int i = 0; i < 10; ++i)
+    {
+        EXPECT_TRUE(s.isElementOnLevel(i, 0));
+        EXPECT_EQ(i % 2 == 0, s.isElementOnLevel(i, 1));
+    }
+
+    EXPECT_EQ(5, s.elementsOnLevel(1));
+}
+
+
+TEST(SkipListSet_ExtendedTests, fingerSearchesAgreeWithOrdinaryOnes)
+{
+    SkipListSet<int> s;
+    SkipListSet<int>::Finger finger;
+
+    // Descending, then ascending, then jumping around.
+    for (int i = 5000; i > 0; --i)
+    {
+        s.add(i * 4, finger);
+    }
+
+    for (int i = 1; i <= 5000; ++i)
+    {
+        s.add(i * 4 + 1, finger);
+        s.add(i * 4 + 1, finger);
+    }
+
+    for (int i = 0; i < 5000; ++i)
+    {
+        s.add((i * 7919) % 5000 * 4 + 2, finger);
+    }
+
+    ASSERT_EQ(15000, s.size());
+
+    for (int i = 0; i <= 20004; ++i)
+    {
+        ASSERT_EQ(s.contains(i), s.contains(i, finger));
+    }
+
+    for (int i = 20004; i >= 0; --i)
+    {
+        ASSERT_EQ(s.contains(i), s.contains(i, finger));
+    }
+}
+
+
+TEST(SkipListSet_ExtendedTests, outOfDateFingersAreIgnored)
+{
+    SkipListSet<std::string> s1;
+    SkipListSet<std::string>::Finger finger;
+
+    s1.add("M", finger);
+    ASSERT_TRUE(s1.contains("M", finger));
+
+    // The set is changed without the finger, so the nodes it remembers are
+    // no longer the ones before "N".
+    s1.add("L");
+    s1.add("MM");
+    s1.add("N", finger);
+
+    ASSERT_TRUE(s1.contains("MM"));
+    ASSERT_TRUE(s1.contains(std::string_view{"N"}, finger));
+
+    SkipListSet<std::string> s2{s1};
+    s2.add("A", finger);
+    EXPECT_TRUE(s2.contains("A", finger));
+    EXPECT_FALSE(s1.contains("A", finger));
+    EXPECT_TRUE(s1.contains("L", finger));
+
+    SkipListSet<std::string> s3;
+    s3 = std::move(s1);
+    EXPECT_FALSE(s1.contains("L", finger));
+    EXPECT_TRUE(s3.contains("L", finger));
+    EXPECT_EQ(5, s2.size());
+    EXPECT_EQ(4, s3.size());
+}
@@ -0,0 +1,40 @@
+// SuggestionEngine.hpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// A SuggestionEngine finds suggested alternative spellings for a misspelled
+// word.  By default, a WordChecker generates every word one edit away from
+// the misspelled one and looks each of them up in its Set; a WordChecker
+// given a SuggestionEngine asks it instead, so that a precomputed index of
+// the dictionary can find suggestions more quickly, or farther away, than
+// those lookups can.
+//
+// A SuggestionEngine is an interface separate from Set, since it usually
+// needs a view of the dictionary that a Set can't provide (such as all of
+// its words at once), and is built from the same words as the WordChecker's
+// Set.
+
+#ifndef SUGGESTIONENGINE_HPP
+#define SUGGESTIONENGINE_HPP
+
+#include <string>
+#include <vector>
+
+
+
+class SuggestionEngine
+{
+public:
+    virtual ~SuggestionEngine() noexcept = default;
+
+
+    // findSuggestions() returns the words of the dictionary that are
+    // suggested alternative spellings for the given word, sorted and
+    // without duplicates.
+    virtual std::vector<std::string> findSuggestions(const std::string& word) const = 0;
+};
+
+
+
+#endif
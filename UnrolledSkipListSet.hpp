@@ -0,0 +1,728 @@
+// UnrolledSkipListSet.hpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// An UnrolledSkipListSet is an implementation of a Set that is a skip list
+// of "blocks" rather than of single elements.  Each block holds up to
+// BLOCK_SIZE elements, in ascending order, and the blocks are themselves in
+// ascending order along level 0; the upper levels, as in a SkipListSet (see
+// SkipListSet.hpp), let a search skip over many blocks at a time, comparing
+// the key only to the first element of each block it passes.  Once the
+// search finds the block where the key belongs, the rest happens within
+// that one block, whose elements are next to one another in memory, much
+// like a search in a B-tree node.  Every block but the last is at least
+// half full, so there are at most about 2n / BLOCK_SIZE blocks, and the
+// searches of the upper levels are shorter, and cost fewer cache misses,
+// by about log2(BLOCK_SIZE / 2) levels.
+//
+// Alongside its elements, a block keeps an array of 64-bit "sort keys," one
+// per element, chosen so that an element with a smaller sort key is always
+// smaller: an integer's value, or the first 8 bytes of a string.  A search
+// counts how many of a block's sort keys are less than the key's with a
+// few vector compares (using AVX2, where it's available, and a loop that
+// compilers can vectorize otherwise), which finds its place in the block
+// without touching the elements at all, except to break ties between equal
+// sort keys.  For other kinds of elements, every sort key is zero, so the
+// elements themselves are compared.
+//
+// A new element goes into the block where it belongs; when that block is
+// full, it's split in two, and the new block's height is chosen by the
+// level tester, exactly as a new element's would be in a SkipListSet.  (An
+// element added after the last one starts a new block instead, so that a
+// set built from a sorted list has full blocks rather than half-full ones.)
+// No element or block ever moves to another part of the list, so adding
+// only changes one block and the pointers leading to the new block after a
+// split.
+
+#ifndef UNROLLEDSKIPLISTSET_HPP
+#define UNROLLEDSKIPLISTSET_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include "KeyLookup.hpp"
+#include "Set.hpp"
+#include "SkipListSet.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+
+
+template <typename ElementType>
+class UnrolledSkipListSet : public Set<ElementType>
+{
+public:
+    // The most elements that a block can hold.
+    static constexpr unsigned int BLOCK_SIZE = 16;
+    static_assert(BLOCK_SIZE == 16, "UnrolledSkipListSet__countLess() compares 16 sort keys");
+
+    // The most levels that an UnrolledSkipListSet will have.
+    static constexpr unsigned int MAX_LEVEL_COUNT = 32;
+
+public:
+    // Initializes an UnrolledSkipListSet to be empty, with or without a
+    // "level tester" object that will decide, whenever a block is created,
+    // whether it should occupy each level above the bottom one.
+    UnrolledSkipListSet();
+    explicit UnrolledSkipListSet(std::unique_ptr<SkipListLevelTester<ElementType>> levelTester);
+
+    // Cleans up the UnrolledSkipListSet so that it leaks no memory.
+    ~UnrolledSkipListSet() noexcept override;
+
+    // Initializes a new UnrolledSkipListSet to be a copy of an existing one,
+    // with the same blocks on the same levels.
+    UnrolledSkipListSet(const UnrolledSkipListSet& s);
+
+    // Initializes a new UnrolledSkipListSet whose contents are moved from an
+    // expiring one.
+    UnrolledSkipListSet(UnrolledSkipListSet&& s) noexcept;
+
+    // Assigns an existing UnrolledSkipListSet into another.
+    UnrolledSkipListSet& operator=(const UnrolledSkipListSet& s);
+
+    // Assigns an expiring UnrolledSkipListSet into another.
+    UnrolledSkipListSet& operator=(UnrolledSkipListSet&& s) noexcept;
+
+
+    bool isImplemented() const noexcept override;
+
+
+    // add() adds an element to the set.  If the element is already in the
+    // set, this function has no effect.  This function runs in an expected
+    // time of O(log n), plus O(BLOCK_SIZE) to make room in the block.
+    void add(const ElementType& element) override;
+
+
+    // contains() returns true if the given element is already in the set,
+    // false otherwise.  This function runs in an expected time of O(log n).
+    bool contains(const ElementType& element) const override;
+
+
+    // contains() can also be given a key of another type that can be
+    // compared to the elements directly.  (See KeyLookup.hpp.)
+    template <typename KeyType, typename = impl_::Set__TransparentKey<ElementType, KeyType>>
+    bool contains(const KeyType& key) const;
+
+
+    // size() returns the number of elements in the set.
+    unsigned int size() const noexcept override;
+
+
+    // levelCount() returns the number of levels in the skip list.
+    unsigned int levelCount() const noexcept;
+
+
+    // blockCount() returns the number of blocks on level 0 (i.e., in all).
+    unsigned int blockCount() const noexcept;
+
+
+private:
+    // A Block is allocated with room for "height" pointers after it, which
+    // forward() returns; forward()[i] is the following block on level i.
+    // The sort keys of unused slots are all ones, so that they're never
+    // less than any key.
+    struct Block
+    {
+        std::uint64_t sortKeys[BLOCK_SIZE];
+        unsigned int count;
+        unsigned int height;
+        alignas(ElementType) unsigned char storage[BLOCK_SIZE * sizeof(ElementType)];
+
+        ElementType* elements() noexcept;
+        const ElementType* elements() const noexcept;
+
+        Block** forward() noexcept;
+        Block* const* forward() const noexcept;
+    };
+
+    static constexpr std::size_t TOWER_OFFSET =
+        (sizeof(Block) + alignof(Block*) - 1) / alignof(Block*) * alignof(Block*);
+
+    std::unique_ptr<SkipListLevelTester<ElementType>> levelTester;
+
+    // head[i] is the first block on level i, or nullptr if it's empty.
+    Block* head[MAX_LEVEL_COUNT];
+    unsigned int levels;
+    unsigned int elementCount;
+    unsigned int blocks;
+
+private:
+    template <typename KeyType>
+    static bool isBefore(const KeyType& key, std::uint64_t sortKey, const Block* block);
+
+    template <typename KeyType>
+    static unsigned int positionIn(const Block* block, const KeyType& key, std::uint64_t sortKey);
+
+    template <typename KeyType>
+    bool find(const KeyType& key) const;
+
+    static void insertAt(Block* block, unsigned int position, const ElementType& element, std::uint64_t sortKey);
+    Block* splitBlock(Block* block, unsigned int keep, const ElementType& element, Block** predecessors[]);
+    unsigned int chooseHeight(const ElementType& element);
+
+    static Block* createBlock(unsigned int height);
+    static void destroyBlock(Block* block) noexcept;
+    void destroyAll() noexcept;
+    void reset() noexcept;
+};
+
+
+
+namespace impl_
+{
+    // UnrolledSkipListSet__sortKey() returns the sort key of a key: for an
+    // integer, its value, adjusted so that negative values are smallest; for
+    // a string, its first 8 bytes, most significant byte first and padded
+    // with zero bytes; and otherwise, zero.
+    template <typename KeyType>
+    std::uint64_t UnrolledSkipListSet__sortKey(const KeyType& key) noexcept
+    {
+        if constexpr (std::is_integral_v<KeyType> && sizeof(KeyType) <= sizeof(std::uint64_t))
+        {
+            if constexpr (std::is_signed_v<KeyType>)
+            {
+                return static_cast<std::uint64_t>(static_cast<std::int64_t>(key)) ^ (std::uint64_t{1} << 63);
+            }
+            else
+            {
+                return static_cast<std::uint64_t>(key);
+            }
+        }
+        else if constexpr (std::is_convertible_v<const KeyType&, std::string_view>)
+        {
+            std::string_view s{key};
+            std::uint64_t sortKey = 0;
+            std::size_t length = s.length() < 8 ? s.length() : 8;
+
+            for (std::size_t i = 0; i < length; ++i)
+            {
+                sortKey |= static_cast<std::uint64_t>(static_cast<unsigned char>(s[i])) << (56 - 8 * i);
+            }
+
+            return sortKey;
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
+
+    // UnrolledSkipListSet__countLess() returns how many of the 16 sort keys
+    // beginning at the given address are less than the given one.
+    inline unsigned int UnrolledSkipListSet__countLess(const std::uint64_t* sortKeys, std::uint64_t sortKey) noexcept
+    {
+#if defined(__AVX2__)
+        // AVX2 only compares signed 64-bit integers, so the high bits are
+        // flipped, which orders unsigned integers the same way.
+        const __m256i flip = _mm256_set1_epi64x(static_cast<long long>(std::uint64_t{1} << 63));
+        const __m256i key = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(sortKey)), flip);
+        unsigned int count = 0;
+
+        for (unsigned int i = 0; i < 16; i += 4)
+        {
+            __m256i keys = _mm256_xor_si256(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(sortKeys + i)), flip);
+
+            int less = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(key, keys)));
+            count += static_cast<unsigned int>(__builtin_popcount(static_cast<unsigned int>(less)));
+        }
+
+        return count;
+#else
+        unsigned int count = 0;
+
+        for (unsigned int i = 0; i < 16; ++i)
+        {
+            count += sortKeys[i] < sortKey ? 1 : 0;
+        }
+
+        return count;
+#endif
+    }
+}
+
+
+
+template <typename ElementType>
+UnrolledSkipListSet<ElementType>::UnrolledSkipListSet()
+    : UnrolledSkipListSet{std::make_unique<RandomSkipListLevelTester<ElementType>>()}
+{
+}
+
+
+template <typename ElementType>
+UnrolledSkipListSet<ElementType>::UnrolledSkipListSet(std::unique_ptr<SkipListLevelTester<ElementType>> levelTester)
+    : levelTester{std::move(levelTester)}
+{
+    reset();
+}
+
+
+template <typename ElementType>
+UnrolledSkipListSet<ElementType>::~UnrolledSkipListSet() noexcept
+{
+    destroyAll();
+}
+
+
+template <typename ElementType>
+UnrolledSkipListSet<ElementType>::UnrolledSkipListSet(const UnrolledSkipListSet& s)
+    : levelTester{s.levelTester != nullptr ? s.levelTester->clone() : nullptr}
+{
+    reset();
+
+    Block** tails[MAX_LEVEL_COUNT];
+
+    for (unsigned int i = 0; i < MAX_LEVEL_COUNT; ++i)
+    {
+        tails[i] = &head[i];
+    }
+
+    try
+    {
+        for (const Block* block = s.head[0]; block != nullptr; block = block->forward()[0])
+        {
+            Block* copy = createBlock(block->height);
+
+            for (unsigned int i = 0; i < block->height; ++i)
+            {
+                *tails[i] = copy;
+                tails[i] = &copy->forward()[i];
+            }
+
+            // The block is linked before it's filled, so that destroyAll()
+            // will find it if copying an element fails.
+            for (; copy->count < block->count; ++copy->count)
+            {
+                new (&copy->elements()[copy->count]) ElementType(block->elements()[copy->count]);
+                copy->sortKeys[copy->count] = block->sortKeys[copy->count];
+            }
+        }
+    }
+    catch (...)
+    {
+        destroyAll();
+        throw;
+    }
+
+    levels = s.levels;
+    elementCount = s.elementCount;
+    blocks = s.blocks;
+}
+
+
+template <typename ElementType>
+UnrolledSkipListSet<ElementType>::UnrolledSkipListSet(UnrolledSkipListSet&& s) noexcept
+{
+    // The expiring UnrolledSkipListSet is left empty, with no level tester,
+    // so any blocks later created in it occupy only level 0.
+    reset();
+    *this = std::move(s);
+}
+
+
+template <typename ElementType>
+UnrolledSkipListSet<ElementType>& UnrolledSkipListSet<ElementType>::operator=(const UnrolledSkipListSet& s)
+{
+    if (this != &s)
+    {
+        UnrolledSkipListSet temp(s);
+        *this = std::move(temp);
+    }
+
+    return *this;
+}
+
+
+template <typename ElementType>
+UnrolledSkipListSet<ElementType>& UnrolledSkipListSet<ElementType>::operator=(UnrolledSkipListSet&& s) noexcept
+{
+    std::swap(levelTester, s.levelTester);
+    std::swap(head, s.head);
+    std::swap(levels, s.levels);
+    std::swap(elementCount, s.elementCount);
+    std::swap(blocks, s.blocks);
+
+    return *this;
+}
+
+
+template <typename ElementType>
+bool UnrolledSkipListSet<ElementType>::isImplemented() const noexcept
+{
+    return true;
+}
+
+
+template <typename ElementType>
+void UnrolledSkipListSet<ElementType>::add(const ElementType& element)
+{
+    std::uint64_t sortKey = impl_::UnrolledSkipListSet__sortKey(element);
+
+    // predecessors[i] is the pointer on level i leading to the first block
+    // on that level that the element is before; "block" ends up as the last
+    // block on level 0 that the element isn't before.
+    Block** predecessors[MAX_LEVEL_COUNT];
+    Block** forward = head;
+    Block* block = nullptr;
+
+    for (unsigned int i = levels; i-- > 0; )
+    {
+        for (Block* next = forward[i]; next != nullptr && !isBefore(element, sortKey, next); next = forward[i])
+        {
+            block = next;
+            forward = next->forward();
+        }
+
+        predecessors[i] = &forward[i];
+    }
+
+    if (block == nullptr)
+    {
+        block = head[0];
+
+        if (block == nullptr)
+        {
+            // The very first element gets a block of its own.
+            unsigned int height = chooseHeight(element);
+            block = createBlock(height);
+
+            for (unsigned int i = 0; i < height; ++i)
+            {
+                head[i] = block;
+            }
+
+            ++blocks;
+        }
+        else
+        {
+            // An element smaller than all the others goes at the front of
+            // the first block, which is first on every level it occupies.
+            for (unsigned int i = 0; i < block->height; ++i)
+            {
+                predecessors[i] = &block->forward()[i];
+            }
+        }
+    }
+
+    unsigned int position = positionIn(block, element, sortKey);
+
+    if (position < block->count && !(element < block->elements()[position]))
+    {
+        return;
+    }
+
+    if (block->count == BLOCK_SIZE)
+    {
+        bool isLast = position == BLOCK_SIZE && block->forward()[0] == nullptr;
+        Block* upper = splitBlock(block, isLast ? BLOCK_SIZE : BLOCK_SIZE / 2, element, predecessors);
+
+        if (position > block->count || block->count == BLOCK_SIZE)
+        {
+            position -= block->count;
+            block = upper;
+        }
+    }
+
+    insertAt(block, position, element, sortKey);
+    ++elementCount;
+}
+
+
+template <typename ElementType>
+bool UnrolledSkipListSet<ElementType>::contains(const ElementType& element) const
+{
+    return find(element);
+}
+
+
+template <typename ElementType>
+template <typename KeyType, typename>
+bool UnrolledSkipListSet<ElementType>::contains(const KeyType& key) const
+{
+    return find(std::string_view{key});
+}
+
+
+// find() searches the upper levels for the last block that the key isn't
+// before, as a SkipListSet searches for an element, then searches within
+// that block.
+template <typename ElementType>
+template <typename KeyType>
+bool UnrolledSkipListSet<ElementType>::find(const KeyType& key) const
+{
+    std::uint64_t sortKey = impl_::UnrolledSkipListSet__sortKey(key);
+    Block* const* forward = head;
+    const Block* block = nullptr;
+    const Block* stop = nullptr;
+
+    for (unsigned int i = levels; i-- > 0; )
+    {
+        for (const Block* next = forward[i]; next != stop && next != nullptr && !isBefore(key, sortKey, next); next = forward[i])
+        {
+            block = next;
+            forward = next->forward();
+        }
+
+        stop = forward[i];
+    }
+
+    if (block == nullptr)
+    {
+        return false;
+    }
+
+    unsigned int position = positionIn(block, key, sortKey);
+    return position < block->count && block->elements()[position] == key;
+}
+
+
+template <typename ElementType>
+unsigned int UnrolledSkipListSet<ElementType>::size() const noexcept
+{
+    return elementCount;
+}
+
+
+template <typename ElementType>
+unsigned int UnrolledSkipListSet<ElementType>::levelCount() const noexcept
+{
+    return levels;
+}
+
+
+template <typename ElementType>
+unsigned int UnrolledSkipListSet<ElementType>::blockCount() const noexcept
+{
+    return blocks;
+}
+
+
+// isBefore() returns true if the key, whose sort key is given, is less
+// than the first element of the given block.  The sort keys settle it,
+// without reaching for the element, unless they're equal.
+template <typename ElementType>
+template <typename KeyType>
+bool UnrolledSkipListSet<ElementType>::isBefore(const KeyType& key, std::uint64_t sortKey, const Block* block)
+{
+    return sortKey < block->sortKeys[0]
+        || (sortKey == block->sortKeys[0] && key < block->elements()[0]);
+}
+
+
+// positionIn() returns the position of the first element of the block that
+// isn't less than the key, or the block's count if there is none.  Only the
+// elements whose sort keys equal the key's are compared to it.
+template <typename ElementType>
+template <typename KeyType>
+unsigned int UnrolledSkipListSet<ElementType>::positionIn(const Block* block, const KeyType& key, std::uint64_t sortKey)
+{
+    unsigned int position = impl_::UnrolledSkipListSet__countLess(block->sortKeys, sortKey);
+
+    while (position < block->count && block->sortKeys[position] == sortKey && block->elements()[position] < key)
+    {
+        ++position;
+    }
+
+    return position;
+}
+
+
+// insertAt() inserts an element into a block that has room for it, moving
+// the elements from the given position onward back by one.
+template <typename ElementType>
+void UnrolledSkipListSet<ElementType>::insertAt(
+    Block* block, unsigned int position, const ElementType& element, std::uint64_t sortKey)
+{
+    ElementType* elements = block->elements();
+
+    if (position == block->count)
+    {
+        new (&elements[position]) ElementType(element);
+    }
+    else
+    {
+        new (&elements[block->count]) ElementType(std::move(elements[block->count - 1]));
+        std::move_backward(elements + position, elements + block->count - 1, elements + block->count);
+        elements[position] = element;
+    }
+
+    std::copy_backward(block->sortKeys + position, block->sortKeys + block->count, block->sortKeys + block->count + 1);
+    block->sortKeys[position] = sortKey;
+    ++block->count;
+}
+
+
+// splitBlock() moves the elements of a full block beyond the first "keep"
+// of them (usually half, but all of them when the element being added goes
+// after the last one) into a new block, which it links in after the full
+// one, given the pointers on each level that lead to the first block after
+// it (see add()).  It returns the new block.
+template <typename ElementType>
+typename UnrolledSkipListSet<ElementType>::Block* UnrolledSkipListSet<ElementType>::splitBlock(
+    Block* block, unsigned int keep, const ElementType& element, Block** predecessors[])
+{
+    ElementType* elements = block->elements();
+    unsigned int oldLevels = levels;
+    unsigned int height = chooseHeight(keep < BLOCK_SIZE ? elements[keep] : element);
+    Block* upper = createBlock(height);
+
+    for (; upper->count < BLOCK_SIZE - keep; ++upper->count)
+    {
+        unsigned int from = keep + upper->count;
+
+        new (&upper->elements()[upper->count]) ElementType(std::move(elements[from]));
+        upper->sortKeys[upper->count] = block->sortKeys[from];
+
+        elements[from].~ElementType();
+        block->sortKeys[from] = ~std::uint64_t{0};
+    }
+
+    block->count = keep;
+
+    for (unsigned int i = oldLevels; i < height; ++i)
+    {
+        predecessors[i] = &head[i];
+    }
+
+    for (unsigned int i = 0; i < height; ++i)
+    {
+        upper->forward()[i] = *predecessors[i];
+        *predecessors[i] = upper;
+    }
+
+    ++blocks;
+    return upper;
+}
+
+
+// chooseHeight() flips coins with the level tester for a new block's
+// height, which is never more than one level above the current top level
+// nor more than MAX_LEVEL_COUNT.
+template <typename ElementType>
+unsigned int UnrolledSkipListSet<ElementType>::chooseHeight(const ElementType& element)
+{
+    unsigned int height = 1;
+
+    while (height <= levels && height < MAX_LEVEL_COUNT
+        && levelTester != nullptr && levelTester->shouldOccupyNextLevel(element))
+    {
+        ++height;
+    }
+
+    if (height > levels)
+    {
+        levels = height;
+    }
+
+    return height;
+}
+
+
+// createBlock() allocates an empty block with room for a tower of the given
+// height, with all of its pointers null.
+template <typename ElementType>
+typename UnrolledSkipListSet<ElementType>::Block* UnrolledSkipListSet<ElementType>::createBlock(unsigned int height)
+{
+    void* memory = ::operator new(TOWER_OFFSET + height * sizeof(Block*));
+    Block* block = new (memory) Block;
+
+    std::fill(block->sortKeys, block->sortKeys + BLOCK_SIZE, ~std::uint64_t{0});
+    block->count = 0;
+    block->height = height;
+
+    Block** tower = block->forward();
+
+    for (unsigned int i = 0; i < height; ++i)
+    {
+        new (&tower[i]) Block*{nullptr};
+    }
+
+    return block;
+}
+
+
+template <typename ElementType>
+void UnrolledSkipListSet<ElementType>::destroyBlock(Block* block) noexcept
+{
+    ElementType* elements = block->elements();
+
+    for (unsigned int i = 0; i < block->count; ++i)
+    {
+        elements[i].~ElementType();
+    }
+
+    block->~Block();
+    ::operator delete(block);
+}
+
+
+template <typename ElementType>
+void UnrolledSkipListSet<ElementType>::destroyAll() noexcept
+{
+    Block* block = head[0];
+
+    while (block != nullptr)
+    {
+        Block* next = block->forward()[0];
+        destroyBlock(block);
+        block = next;
+    }
+
+    reset();
+}
+
+
+template <typename ElementType>
+void UnrolledSkipListSet<ElementType>::reset() noexcept
+{
+    for (unsigned int i = 0; i < MAX_LEVEL_COUNT; ++i)
+    {
+        head[i] = nullptr;
+    }
+
+    levels = 1;
+    elementCount = 0;
+    blocks = 0;
+}
+
+
+template <typename ElementType>
+ElementType* UnrolledSkipListSet<ElementType>::Block::elements() noexcept
+{
+    return std::launder(reinterpret_cast<ElementType*>(storage));
+}
+
+
+template <typename ElementType>
+const ElementType* UnrolledSkipListSet<ElementType>::Block::elements() const noexcept
+{
+    return std::launder(reinterpret_cast<const ElementType*>(storage));
+}
+
+
+template <typename ElementType>
+typename UnrolledSkipListSet<ElementType>::Block** UnrolledSkipListSet<ElementType>::Block::forward() noexcept
+{
+    return reinterpret_cast<Block**>(reinterpret_cast<char*>(this) + TOWER_OFFSET);
+}
+
+
+template <typename ElementType>
+typename UnrolledSkipListSet<ElementType>::Block* const* UnrolledSkipListSet<ElementType>::Block::forward() const noexcept
+{
+    return reinterpret_cast<Block* const*>(reinterpret_cast<const char*>(this) + TOWER_OFFSET);
+}
+
+
+
+#endif
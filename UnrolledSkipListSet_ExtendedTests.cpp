@@ -0,0 +1,178 @@
+// UnrolledSkipListSet_ExtendedTests.cpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// These unit tests check that an UnrolledSkipListSet finds what's added to
+// it, whatever the elements' sort keys are, and that its blocks are split
+// and filled as described in UnrolledSkipListSet.hpp.
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <gtest/gtest.h>
+#include "UnrolledSkipListSet.hpp"
+
+
+namespace
+{
+    template <typename ElementType>
+    class NeverGrowSkipListLevelTester : public SkipListLevelTester<ElementType>
+    {
+    public:
+        bool shouldOccupyNextLevel(const ElementType&) override
+        {
+            return false;
+        }
+
+        std::unique_ptr<SkipListLevelTester<ElementType>> clone() override
+        {
+            return std::make_unique<NeverGrowSkipListLevelTester>();
+        }
+    };
+}
+
+
+TEST(UnrolledSkipListSet_ExtendedTests, containsElementsAddedInAnyOrder)
+{
+    std::vector<int> elements;
+
+    for (int i = -10000; i < 10000; ++i)
+    {
+        elements.push_back(i * 2);
+    }
+
+    std::shuffle(elements.begin(), elements.end(), std::default_random_engine{46});
+
+    UnrolledSkipListSet<int> s;
+
+    for (int element : elements)
+    {
+        s.add(element);
+        s.add(element);
+    }
+
+    ASSERT_EQ(20000, s.size());
+
+    for (int i = -10000; i < 10000; ++i)
+    {
+        ASSERT_TRUE(s.contains(i * 2));
+        ASSERT_FALSE(s.contains(i * 2 + 1));
+    }
+
+    // Every block but the last is at least half full.
+    EXPECT_LE(s.blockCount(), 20000 / (UnrolledSkipListSet<int>::BLOCK_SIZE / 2) + 1);
+}
+
+
+TEST(UnrolledSkipListSet_ExtendedTests, sortedAdditionsFillEveryBlock)
+{
+    UnrolledSkipListSet<int> s;
+
+    for (int i = 0; i < 1600; ++i)
+    {
+        s.add(i);
+    }
+
+    EXPECT_EQ(1600, s.size());
+    EXPECT_EQ(1600 / UnrolledSkipListSet<int>::BLOCK_SIZE, s.blockCount());
+    EXPECT_TRUE(s.contains(0));
+    EXPECT_TRUE(s.contains(1599));
+    EXPECT_FALSE(s.contains(1600));
+}
+
+
+TEST(UnrolledSkipListSet_ExtendedTests, stringsWithTheSameSortKeyAreToldApart)
+{
+    // All of these begin with the same eight bytes (or are a prefix of
+    // them), so their sort keys can't tell them apart.
+    std::vector<std::string> words{
+        "PREFIXEDWORD", "PREFIXED", "PREFIX", "PREFIXEDA", "PREFIXEDZ",
+        "PREFIXED\xFF", "PREFIXEDWORDS", "PREFIXEDB"};
+
+    UnrolledSkipListSet<std::string> s;
+
+    for (int round = 0; round < 3; ++round)
+    {
+        for (const std::string& word : words)
+        {
+            s.add(word + std::string(round, 'X'));
+        }
+    }
+
+    EXPECT_EQ(24, s.size());
+
+    for (const std::string& word : words)
+    {
+        EXPECT_TRUE(s.contains(word));
+        EXPECT_TRUE(s.contains(word + "XX"));
+        EXPECT_FALSE(s.contains(word + "Y"));
+    }
+
+    std::string_view text{"PREFIXEDWORD AND PREFIXEDB"};
+    EXPECT_TRUE(s.contains(text.substr(0, 12)));
+    EXPECT_TRUE(s.contains(text.substr(17)));
+    EXPECT_FALSE(s.contains(text.substr(0, 7)));
+}
+
+
+TEST(UnrolledSkipListSet_ExtendedTests, elementsWithoutSortKeysAreCompared)
+{
+    UnrolledSkipListSet<double> s;
+
+    for (int i = 100; i > 0; --i)
+    {
+        s.add(i / 4.0);
+    }
+
+    EXPECT_EQ(100, s.size());
+    EXPECT_TRUE(s.contains(0.25));
+    EXPECT_TRUE(s.contains(12.5));
+    EXPECT_FALSE(s.contains(12.6));
+}
+
+
+TEST(UnrolledSkipListSet_ExtendedTests, worksWithOneLevel)
+{
+    UnrolledSkipListSet<int> s{std::make_unique<NeverGrowSkipListLevelTester<int>>()};
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        s.add((i * 7) % 1000);
+    }
+
+    EXPECT_EQ(1, s.levelCount());
+    EXPECT_EQ(1000, s.size());
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        ASSERT_TRUE(s.contains(i));
+    }
+}
+
+
+TEST(UnrolledSkipListSet_ExtendedTests, copiesAreIndependent)
+{
+    UnrolledSkipListSet<std::string> s1;
+
+    for (int i = 0; i < 500; ++i)
+    {
+        s1.add("WORD" + std::to_string(i));
+    }
+
+    UnrolledSkipListSet<std::string> s2{s1};
+    s2.add("BOO");
+
+    EXPECT_EQ(500, s1.size());
+    EXPECT_EQ(501, s2.size());
+    EXPECT_FALSE(s1.contains("BOO"));
+    EXPECT_TRUE(s2.contains("BOO"));
+    EXPECT_TRUE(s2.contains("WORD499"));
+
+    UnrolledSkipListSet<std::string> s3{std::move(s2)};
+    EXPECT_EQ(501, s3.size());
+    EXPECT_EQ(0, s2.size());
+}
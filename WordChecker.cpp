@@ -1,11 +1,107 @@
 #include "WordChecker.hpp"
-#include <algorithm> // For std::sort and std::unique
+#include <algorithm> // For std::sort and std::adjacent_find
+#include <memory>
+#include <utility>
+
+namespace {
+    // The letters that candidates are made by inserting and replacing.
+    constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+    // The scratch space that findSuggestions() builds candidates in.  There
+    // is one per thread, so its memory is reused from one call to the next,
+    // and once it has grown large enough, only the accepted suggestions
+    // allocate anything.
+    struct Scratch {
+        std::string candidate;
+
+        // For a batch lookup, every candidate is built end to end in this
+        // one buffer, recording where each one starts and how long it is.
+        std::string buffer;
+        std::vector<std::pair<size_t, size_t>> extents;
+        std::vector<std::string_view> candidates;
+        std::unique_ptr<bool[]> found;
+        size_t foundCapacity = 0;
+    };
+
+    thread_local Scratch scratch;
+
+    // forEachCandidate() calls visit with each word one edit away from the
+    // given word, each built by editing candidate in place and undone once
+    // visit returns.  No candidate is visited twice: edits that would give
+    // the same result as another (swapping equal characters, or inserting
+    // or deleting a character next to an equal one) are skipped, so the
+    // results need no deduplication.
+    template <typename Visit>
+    void forEachCandidate(const std::string& word, std::string& candidate, Visit&& visit)
+    {
+        candidate.reserve(word.length() + 1);
+        candidate.assign(word);
+
+        // Replacing a letter with itself, or swapping two equal neighbours,
+        // gives the word itself, which is only a candidate if the word has
+        // a letter from the alphabet or a repeated character.
+        bool hasLetter = word.find_first_of(alphabet) != std::string::npos;
+        bool hasRepeat = std::adjacent_find(word.begin(), word.end()) != word.end();
+        if (hasLetter || hasRepeat) {
+            visit(candidate);
+        }
+
+        // Swapping adjacent characters
+        for (size_t i = 0; i + 1 < word.length(); ++i) {
+            if (word[i] != word[i + 1]) {
+                std::swap(candidate[i], candidate[i + 1]);
+                visit(candidate);
+                std::swap(candidate[i], candidate[i + 1]);
+            }
+        }
+
+        // Replacing characters with alphabet letters
+        for (size_t i = 0; i < word.length(); ++i) {
+            for (char ch : alphabet) {
+                if (ch != word[i]) {
+                    candidate[i] = ch;
+                    visit(candidate);
+                }
+            }
+            candidate[i] = word[i];
+        }
+
+        // Inserting a character; inserting one just after an equal one is
+        // the same as inserting it just before.
+        for (size_t i = 0; i <= word.length(); ++i) { // Note the <= to handle insertions at the end
+            for (char ch : alphabet) {
+                if (i == 0 || word[i - 1] != ch) {
+                    candidate.insert(i, 1, ch);
+                    visit(candidate);
+                    candidate.erase(i, 1);
+                }
+            }
+        }
+
+        // Removing each character; removing one of a run of equal
+        // characters is the same as removing any other.
+        for (size_t i = 0; i < word.length(); ++i) {
+            if (i == 0 || word[i - 1] != word[i]) {
+                candidate.erase(i, 1);
+                visit(candidate);
+                candidate.insert(i, 1, word[i]);
+            }
+        }
+    }
+}
 
 WordChecker::WordChecker(const Set<std::string>& words)
-    : words(words)
+    : words(words), batchWords(dynamic_cast<const BatchLookup<std::string_view>*>(&words)),
+      suggestionEngine(nullptr)
 {
 }
 
+WordChecker::WordChecker(const Set<std::string>& words, const SuggestionEngine& suggestionEngine)
+    : WordChecker(words)
+{
+    this->suggestionEngine = &suggestionEngine;
+}
+
 bool WordChecker::wordExists(const std::string& word) const
 {
     return words.contains(word);
@@ -13,49 +109,57 @@ bool WordChecker::wordExists(const std::string& word) const
 
 std::vector<std::string> WordChecker::findSuggestions(const std::string& word) const
 {
+    if (suggestionEngine != nullptr) {
+        return suggestionEngine->findSuggestions(word);
+    }
+
     std::vector<std::string> suggestions;
 
-    // Swapping adjacent characters
-    for (size_t i = 0; i < word.length() - 1; ++i) {
-        std::string swapped = word;
-        std::swap(swapped[i], swapped[i + 1]);
-        if (wordExists(swapped)) {
-            suggestions.push_back(swapped);
-        }
+    if (batchWords == nullptr) {
+        // Each candidate is looked up as soon as it's built.
+        forEachCandidate(word, scratch.candidate, [&](const std::string& candidate) {
+            if (words.contains(candidate)) {
+                suggestions.push_back(candidate);
+            }
+        });
+    } else {
+        findInBatch(word, suggestions);
     }
 
-    // Replacing characters with alphabet letters and inserting a character
-    std::string alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
-    for (size_t i = 0; i <= word.length(); ++i) { // Note the <= to handle insertions at the end
-        for (char ch : alphabet) {
-            // Inserting a character from the alphabet
-            std::string inserted = word.substr(0, i) + ch + word.substr(i);
-            if (wordExists(inserted)) {
-                suggestions.push_back(inserted);
-            }
-            // Replacing a character only if i < word.length() to avoid out-of-bounds
-            if (i < word.length()) {
-                std::string replaced = word;
-                replaced[i] = ch;
-                if (wordExists(replaced)) {
-                    suggestions.push_back(replaced);
-                }
-            }
-        }
+    std::sort(suggestions.begin(), suggestions.end());
+
+    return suggestions;
+}
+
+void WordChecker::findInBatch(const std::string& word, std::vector<std::string>& suggestions) const
+{
+    // Every candidate is built before any is looked up, so that they can
+    // all be looked up together.
+    scratch.buffer.clear();
+    scratch.extents.clear();
+
+    forEachCandidate(word, scratch.candidate, [&](const std::string& candidate) {
+        scratch.extents.emplace_back(scratch.buffer.size(), candidate.length());
+        scratch.buffer.append(candidate);
+    });
+
+    // The buffer is finished growing, so views into it stay valid.
+    scratch.candidates.clear();
+    for (const auto& [start, length] : scratch.extents) {
+        scratch.candidates.emplace_back(scratch.buffer.data() + start, length);
     }
 
-    // Removing each character
-    for (size_t i = 0; i < word.length(); ++i) {
-        std::string removed = word.substr(0, i) + word.substr(i + 1);
-        if (wordExists(removed)) {
-            suggestions.push_back(removed);
-        }
+    size_t count = scratch.candidates.size();
+    if (scratch.foundCapacity < count) {
+        scratch.found.reset(new bool[count]);
+        scratch.foundCapacity = count;
     }
 
-    // Remove duplicate suggestions
-    std::sort(suggestions.begin(), suggestions.end());
-    auto last = std::unique(suggestions.begin(), suggestions.end());
-    suggestions.erase(last, suggestions.end());
+    batchWords->containsMany(scratch.candidates.data(), count, scratch.found.get());
 
-    return suggestions;
+    for (size_t i = 0; i < count; ++i) {
+        if (scratch.found[i]) {
+            suggestions.emplace_back(scratch.candidates[i]);
+        }
+    }
 }
@@ -17,8 +17,11 @@
 #define WORDCHECKER_HPP
 
 #include <string>
+#include <string_view>
 #include <vector>
+#include "BatchLookup.hpp"
 #include "Set.hpp"
+#include "SuggestionEngine.hpp"
 
 
 
@@ -31,6 +34,13 @@ public:
     WordChecker(const Set<std::string>& words);
 
 
+    // A WordChecker can also be given a SuggestionEngine (see
+    // SuggestionEngine.hpp), which findSuggestions() will ask for its
+    // suggestions instead of generating them itself.  It stores a reference
+    // to the engine, too.
+    WordChecker(const Set<std::string>& words, const SuggestionEngine& suggestionEngine);
+
+
     // wordExists() returns true if the given word is spelled correctly,
     // false otherwise.
     bool wordExists(const std::string& word) const;
@@ -38,12 +48,25 @@ public:
 
     // findSuggestions() returns a vector containing suggested alternative
     // spellings for the given word, using the five algorithms described in
-    // the project write-up.
+    // the project write-up, unless the WordChecker was given a
+    // SuggestionEngine, in which case the suggestions are the engine's.
     std::vector<std::string> findSuggestions(const std::string& word) const;
 
 
 private:
     const Set<std::string>& words;
+
+    // If the Set can search for many words at once (see BatchLookup.hpp),
+    // this points to it; otherwise, it's null.
+    const BatchLookup<std::string_view>* batchWords;
+
+    // The SuggestionEngine that findSuggestions() asks, if there is one;
+    // otherwise, it's null.
+    const SuggestionEngine* suggestionEngine;
+
+    // findInBatch() adds to suggestions the words one edit away from the
+    // given one, looking them all up at once with batchWords.
+    void findInBatch(const std::string& word, std::vector<std::string>& suggestions) const;
 };
 
 
@@ -0,0 +1,117 @@
+// WordChecker_ExtendedTests.cpp
+//
+// ICS 46 Winter 2022
+// Project #4: Set the Controls for the Heart of the Sun
+//
+// These unit tests go beyond the sanity-checking tests, checking that the
+// WordChecker finds the same suggestions no matter which kind of Set holds
+// its words, and that it suggests each word only once, even for words that
+// are empty or have repeated letters.
+
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+#include "HashSet.hpp"
+#include "VectorSet.hpp"
+#include "WordChecker.hpp"
+
+
+TEST(WordChecker_ExtendedTests, suggestionsAreTheSameWithBatchLookups)
+{
+    std::vector<std::string> dictionary{
+        "CAT", "CART", "CAST", "CT", "ACT", "CAB", "BAT", "COAT", "AT", "CA", "SCAT"
+    };
+
+    VectorSet<std::string> vectorSet;
+    HashSet<std::string, WyHash> hashSet;
+
+    for (const std::string& word : dictionary)
+    {
+        vectorSet.add(word);
+        hashSet.add(word);
+    }
+
+    WordChecker vectorChecker{vectorSet};
+    WordChecker hashChecker{hashSet};
+
+    for (const char* word : {"CAT", "CT", "CART", "XYZ", "CATS", "AC"})
+    {
+        std::vector<std::string> expected = vectorChecker.findSuggestions(word);
+
+        EXPECT_EQ(expected, hashChecker.findSuggestions(word));
+    }
+
+    // Replacing a letter with itself suggests the word itself.
+    std::vector<std::string> expected{
+        "ACT", "AT", "BAT", "CA", "CAB", "CART", "CAST", "CAT", "COAT", "CT", "SCAT"
+    };
+    EXPECT_EQ(expected, hashChecker.findSuggestions("CAT"));
+}
+
+
+TEST(WordChecker_ExtendedTests, suggestionsForRepeatedLettersAreNotDuplicated)
+{
+    std::vector<std::string> dictionary{
+        "AAB", "AB", "ABB", "BA", "A", "B", "AAAB", "ABAB", "BAA", "AA"
+    };
+
+    VectorSet<std::string> vectorSet;
+    HashSet<std::string, WyHash> hashSet;
+
+    for (const std::string& word : dictionary)
+    {
+        vectorSet.add(word);
+        hashSet.add(word);
+    }
+
+    WordChecker vectorChecker{vectorSet};
+    WordChecker hashChecker{hashSet};
+
+    std::vector<std::string> expected{"AA", "AAAB", "AAB", "AB", "ABAB", "ABB"};
+    EXPECT_EQ(expected, vectorChecker.findSuggestions("AAB"));
+    EXPECT_EQ(expected, hashChecker.findSuggestions("AAB"));
+
+    expected = {"A", "AA", "AAB", "AB", "ABB", "B", "BA"};
+    EXPECT_EQ(expected, vectorChecker.findSuggestions("AB"));
+    EXPECT_EQ(expected, hashChecker.findSuggestions("AB"));
+}
+
+
+TEST(WordChecker_ExtendedTests, emptyWordsCanBeChecked)
+{
+    HashSet<std::string, WyHash> words;
+    words.add("A");
+    words.add("BE");
+    words.add("");
+
+    WordChecker checker{words};
+
+    // Only inserting a letter can make a word out of an empty one.
+    std::vector<std::string> expected{"A"};
+    EXPECT_EQ(expected, checker.findSuggestions(""));
+    EXPECT_TRUE(checker.wordExists(""));
+}
+
+
+TEST(WordChecker_ExtendedTests, wordsWithoutLettersAreNotTheirOwnSuggestions)
+{
+    HashSet<std::string, WyHash> words;
+    words.add("123");
+    words.add("cat");
+    words.add("100");
+    words.add("cAt");
+
+    WordChecker checker{words};
+
+    // No edit of "123" or "cat" gives the word back, since neither has a
+    // letter from A to Z to replace with itself or two equal neighbours
+    // to swap.
+    EXPECT_TRUE(checker.findSuggestions("123").empty());
+
+    std::vector<std::string> expected{"cAt"};
+    EXPECT_EQ(expected, checker.findSuggestions("cat"));
+
+    // "100" has two equal neighbours, so it does.
+    expected = {"100"};
+    EXPECT_EQ(expected, checker.findSuggestions("100"));
+}